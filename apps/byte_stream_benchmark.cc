@@ -0,0 +1,58 @@
+#include "byte_stream.hh"
+#include "tcp_config.hh"
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+using namespace std;
+using namespace std::chrono;
+
+constexpr size_t len = 256 * 1024 * 1024;
+
+//! Push `len` bytes through a ByteStream in `write_size` pieces, draining it whenever it fills up
+void main_loop(const size_t write_size) {
+    ByteStream stream{TCPConfig::DEFAULT_CAPACITY};
+    const string chunk(write_size, 'x');
+
+    size_t bytes_moved = 0;
+
+    const auto first_time = high_resolution_clock::now();
+
+    while (bytes_moved < len) {
+        while (stream.remaining_capacity() > 0) {
+            stream.write(chunk);
+        }
+        const auto available_output = stream.buffer_size();
+        if (stream.peek_output(available_output).size() != available_output) {
+            throw runtime_error("peek_output() returned a short string");
+        }
+        stream.pop_output(available_output);
+        bytes_moved += available_output;
+    }
+
+    const auto final_time = high_resolution_clock::now();
+
+    const auto duration = duration_cast<nanoseconds>(final_time - first_time).count();
+
+    const auto gigabytes_per_second = bytes_moved / double(duration);
+
+    cout << fixed << setprecision(2);
+    cout << "ByteStream throughput with " << setw(5) << write_size << "-byte writes: " << gigabytes_per_second
+         << " GB/s\n";
+}
+
+int main() {
+    try {
+        main_loop(16);
+        main_loop(TCPConfig::MAX_PAYLOAD_SIZE);
+        main_loop(16384);
+    } catch (const exception &e) {
+        cerr << e.what() << "\n";
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,157 @@
+#include "lossy_fd_adapter.hh"
+#include "tcp_config.hh"
+#include "tcp_connection.hh"
+
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <queue>
+#include <string>
+#include <utility>
+
+using namespace std;
+
+constexpr size_t len = 8 * 1024 * 1024;      // bytes transferred per run
+constexpr double bottleneck_rate = 1250;     // bytes per millisecond (10 Mbit/s)
+constexpr uint64_t one_way_delay = 20;       // milliseconds
+constexpr size_t queue_limit = 60000;        // bytes the bottleneck can buffer
+constexpr uint64_t time_limit = 600 * 1000;  // milliseconds before a run is abandoned
+constexpr size_t header_overhead = 40;       // IP and TCP headers, in bytes
+
+//! \brief One direction of a simulated path: a drop-tail bottleneck queue followed by a fixed delay
+
+//! It has the interface LossyFdAdapter expects of an FdAdapter, so random
+//! loss is added exactly as it would be on a real TUN or UDP adapter.
+class SimulatedLink {
+  private:
+    FdAdapterConfig _cfg{};
+    queue<pair<uint64_t, TCPSegment>> _in_flight{};  //!< (arrival time, segment)
+    uint64_t _now{0};
+    uint64_t _link_free_at{0};  //!< when the bottleneck finishes the segments already queued on it
+
+  public:
+    //! Deliver the next segment that has reached the far end, if any
+    optional<TCPSegment> read() {
+        if (_in_flight.empty() or _in_flight.front().first > _now) {
+            return {};
+        }
+        TCPSegment seg = move(_in_flight.front().second);
+        _in_flight.pop();
+        return seg;
+    }
+
+    //! Queue a segment at the bottleneck, or drop it if the queue is full
+    void write(TCPSegment &seg) {
+        const double size = static_cast<double>(seg.payload().size() + header_overhead);
+        const uint64_t start = max(_now, _link_free_at);
+        if (static_cast<double>(start - _now) * bottleneck_rate > static_cast<double>(queue_limit)) {
+            return;
+        }
+        _link_free_at = start + static_cast<uint64_t>(size / bottleneck_rate + 0.5);
+        _in_flight.emplace(_link_free_at + one_way_delay, seg);
+    }
+
+    void set_listening(const bool) {}
+    const FdAdapterConfig &config() const { return _cfg; }
+    FdAdapterConfig &config_mut() { return _cfg; }
+    void tick(const size_t ms_since_last_tick) { _now += ms_since_last_tick; }
+};
+
+//! \returns the milliseconds it took to move `len` bytes across the simulated path, if it finished in time
+optional<uint64_t> run(const CongestionControl algorithm, const bool pacing, const double loss) {
+    TCPConfig config;
+    config.congestion_control = algorithm;
+    config.pacing = pacing;
+    config.rt_timeout = 200;
+    config.adaptive_rto = true;
+    config.fast_retransmit = true;
+    TCPConnection x{config}, y{config};
+
+    LossyFdAdapter<SimulatedLink> uplink{SimulatedLink{}}, downlink{SimulatedLink{}};
+    uplink.config_mut().loss_rate_up = static_cast<uint16_t>(loss * 65536);
+
+    size_t remaining = len;
+    size_t received = 0;
+    optional<uint64_t> finished{};
+    x.connect();
+    y.end_input_stream();
+
+    // run until both sides have closed, so the transfer ends the way a real one would
+    for (uint64_t now = 0; now < time_limit and (x.active() or y.active()); now++) {
+        while (remaining > 0 and x.remaining_outbound_capacity() > 0) {
+            remaining -= x.write(string(min(remaining, x.remaining_outbound_capacity()), 'x'));
+            if (remaining == 0) {
+                x.end_input_stream();
+            }
+        }
+
+        while (not x.segments_out().empty()) {
+            uplink.write(x.segments_out().front());
+            x.segments_out().pop();
+        }
+        while (not y.segments_out().empty()) {
+            downlink.write(y.segments_out().front());
+            y.segments_out().pop();
+        }
+
+        uplink.tick(1);
+        downlink.tick(1);
+        x.tick(1);
+        y.tick(1);
+
+        while (auto seg = uplink.read()) {
+            y.segment_received(*seg);
+        }
+        while (auto seg = downlink.read()) {
+            x.segment_received(*seg);
+        }
+
+        const size_t available = y.inbound_stream().buffer_size();
+        received += available;
+        y.inbound_stream().pop_output(available);
+        if (received == len and not finished.has_value()) {
+            finished = now;
+        }
+    }
+    return finished;
+}
+
+int main() {
+    try {
+        const auto algorithms = {make_pair(CongestionControl::none, "none"),
+                                 make_pair(CongestionControl::newreno, "newreno"),
+                                 make_pair(CongestionControl::cubic, "cubic"),
+                                 make_pair(CongestionControl::bbr, "bbr")};
+        const auto losses = {0.0, 0.001, 0.01, 0.05};
+
+        cout << "Goodput over a " << bottleneck_rate * 8 / 1000 << " Mbit/s path with a " << 2 * one_way_delay
+             << " ms RTT, by loss rate:\n";
+        cout << setw(16) << "";
+        for (const double loss : losses) {
+            cout << setw(10) << (to_string(loss * 100).substr(0, 4) + "%");
+        }
+        cout << "\n";
+
+        for (const auto &[algorithm, name] : algorithms) {
+            for (const bool pacing : {false, true}) {
+                cout << setw(16) << (string(name) + (pacing ? "+pacing" : ""));
+                for (const double loss : losses) {
+                    const auto duration = run(algorithm, pacing, loss);
+                    if (duration.has_value()) {
+                        const double mbit_per_s = static_cast<double>(len) * 8 / static_cast<double>(*duration) / 1000;
+                        cout << setw(10) << fixed << setprecision(2) << mbit_per_s;
+                    } else {
+                        cout << setw(10) << "-";
+                    }
+                    cout << flush;
+                }
+                cout << " Mbit/s\n";
+            }
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << "\n";
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -107,7 +107,9 @@ class NetworkInterfaceAdapter : public TCPOverIPv4Adapter {
         return {};
     }
     void write(TCPSegment &seg) {
-        _interface.send_datagram(wrap_tcp_in_ip(seg), _next_hop);
+        for (const InternetDatagram &ip_dgram : wrap_tcp_in_ips(seg)) {
+            _interface.send_datagram(ip_dgram, _next_hop);
+        }
         send_pending();
     }
     void tick(const size_t ms_since_last_tick) {
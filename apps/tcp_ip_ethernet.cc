@@ -29,6 +29,9 @@ static void show_usage(const char *argv0, const char *msg) {
          << "   -w <winsz>      Use a window of <winsz> bytes                   " << TCPConfig::MAX_PAYLOAD_SIZE
          << "\n\n"
 
+         << "   -m <mss>        Send and accept segments of up to <mss> bytes   " << TCPConfig::MAX_PAYLOAD_SIZE << "\n"
+         << "                   (lowered to fit the MTU of a TUN or TAP device)\n\n"
+
          << "   -t <tmout>      Set rt_timeout to tmout                         " << TCPConfig::TIMEOUT_DFLT << "\n\n"
 
          << "   -d <tapdev>     Connect to tap <tapdev>                         " << TAP_DFLT << "\n\n"
@@ -80,6 +83,11 @@ static tuple<TCPConfig, FdAdapterConfig, Address, string> get_config(int argc, c
             c_fsm.recv_capacity = strtol(argv[curr + 1], nullptr, 0);
             curr += 2;
 
+        } else if (strncmp("-m", argv[curr], 3) == 0) {
+            check_argc(argc, argv, curr, "ERROR: -m requires one argument.");
+            c_fsm.mss = strtol(argv[curr + 1], nullptr, 0);
+            curr += 2;
+
         } else if (strncmp("-t", argv[curr], 3) == 0) {
             check_argc(argc, argv, curr, "ERROR: -t requires one argument.");
             c_fsm.rt_timeout = strtol(argv[curr + 1], nullptr, 0);
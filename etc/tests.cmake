@@ -21,6 +21,13 @@ add_test(NAME t_send_window          COMMAND send_window)
 add_test(NAME t_send_ack             COMMAND send_ack)
 add_test(NAME t_send_close           COMMAND send_close)
 add_test(NAME t_send_extra           COMMAND send_extra)
+add_test(NAME t_send_congestion      COMMAND send_congestion)
+add_test(NAME t_send_rto             COMMAND send_rto)
+add_test(NAME t_send_fast_retx       COMMAND send_fast_retx)
+add_test(NAME t_send_sack            COMMAND send_sack)
+add_test(NAME t_send_pacing          COMMAND send_pacing)
+add_test(NAME t_send_gso             COMMAND send_gso)
+add_test(NAME t_send_persist         COMMAND send_persist)
 
 add_test(NAME t_strm_reassem_single      COMMAND fsm_stream_reassembler_single)
 add_test(NAME t_strm_reassem_seq         COMMAND fsm_stream_reassembler_seq)
@@ -30,12 +37,18 @@ add_test(NAME t_strm_reassem_many        COMMAND fsm_stream_reassembler_many)
 add_test(NAME t_strm_reassem_overlapping COMMAND fsm_stream_reassembler_overlapping)
 add_test(NAME t_strm_reassem_win         COMMAND fsm_stream_reassembler_win)
 add_test(NAME t_strm_reassem_cap         COMMAND fsm_stream_reassembler_cap)
+add_test(NAME t_strm_reassem_fast        COMMAND fsm_stream_reassembler_fast)
 
 add_test(NAME t_byte_stream_construction COMMAND byte_stream_construction)
 add_test(NAME t_byte_stream_one_write    COMMAND byte_stream_one_write)
 add_test(NAME t_byte_stream_two_writes   COMMAND byte_stream_two_writes)
 add_test(NAME t_byte_stream_capacity     COMMAND byte_stream_capacity)
 add_test(NAME t_byte_stream_many_writes  COMMAND byte_stream_many_writes)
+add_test(NAME t_byte_stream_zero_copy    COMMAND byte_stream_zero_copy)
+add_test(NAME t_memory_budget            COMMAND memory_budget)
+add_test(NAME t_tcp_options              COMMAND tcp_options "${PROJECT_SOURCE_DIR}/tests/ipv4_parser.data")
+add_test(NAME t_tcp_gso                  COMMAND tcp_gso)
+add_test(NAME t_tcp_gro                  COMMAND tcp_gro)
 
 add_test(NAME t_webget               COMMAND "${PROJECT_SOURCE_DIR}/tests/webget_t.sh")
 
@@ -62,6 +75,11 @@ add_test(NAME t_retx_win             COMMAND fsm_retx_win)
 add_test(NAME t_loopback             COMMAND fsm_loopback)
 add_test(NAME t_loopback_win         COMMAND fsm_loopback_win)
 add_test(NAME t_reorder              COMMAND fsm_reorder)
+add_test(NAME t_sack                 COMMAND fsm_sack)
+add_test(NAME t_mss                  COMMAND fsm_mss)
+add_test(NAME t_window_scale         COMMAND fsm_window_scale)
+add_test(NAME t_timestamps           COMMAND fsm_timestamps)
+add_test(NAME t_delayed_ack          COMMAND fsm_delayed_ack)
 
 add_test(NAME t_address_dt           COMMAND address_dt)
 add_test(NAME t_parser_dt            COMMAND parser_dt)
@@ -1,40 +1,211 @@
 #include "byte_stream.hh"
 
+#include "file_descriptor.hh"
+#include "memory_budget.hh"
+
+#include <stdexcept>
+
 using namespace std;
 
-ByteStream::ByteStream(const size_t capacity) : _capacity(capacity) { ringBuffer.resize(_capacity); }
+ByteStream::ByteStream(const size_t capacity) : _capacity(capacity) {}
 
+//! \details Only the part of `data` that fits is copied, once, into the
+//! stream's chunks.
 size_t ByteStream::write(const string &data) {
     if (input_ended()) {
         set_error();
         return 0;
     }
-    size_t length = std::min(remaining_capacity(), data.size());
-    for (size_t i = 0; i < length; ++i) {
-        ringBuffer[_write_ptr] = data[i];
-        advance_write(1);
+    size_t copied = 0;
+    while (copied < data.size() && remaining_capacity() > 0) {
+        char *tail = chunk_tail();
+        const size_t length =
+            std::min({data.size() - copied, remaining_capacity(), _chunk->size() - _chunk_used});
+        data.copy(tail, length, copied);
+        publish(length);
+        copied += length;
+    }
+    return copied;
+}
+
+//! \details The Buffer is appended to the chain as-is, after trimming
+//! whatever does not fit in the remaining capacity. Its storage is charged
+//! to the MemoryBudget (see MemoryBudget::adopt()) for as long as it is held.
+size_t ByteStream::write(Buffer data) {
+    if (input_ended()) {
+        set_error();
+        return 0;
+    }
+    const size_t length = std::min(remaining_capacity(), data.size());
+    if (length == 0) {
+        return 0;
     }
+    data.remove_suffix(data.size() - length);
+    _buffers.push_back(MemoryBudget::global().adopt(data));
     _size += length;
+    _peak_size = std::max(_peak_size, _size);
     _write_bytes_count += length;
     return length;
 }
 
+char *ByteStream::chunk_tail() {
+    if (!_chunk || _chunk_used == _chunk->size()) {
+        _chunk = _next_chunk ? move(_next_chunk) : new_chunk();
+        _chunk_used = 0;
+    }
+    return _chunk->data() + _chunk_used;
+}
+
+shared_ptr<string> ByteStream::new_chunk() {
+    const size_t size = std::min(_next_chunk_size, _capacity);
+    _next_chunk_size = std::min(2 * _next_chunk_size, CHUNK_SIZE);
+    return MemoryBudget::global().make_chunk(size);
+}
+
+//! \param[in] len the number of bytes just placed at the tail of the current chunk
+void ByteStream::publish(const size_t len) {
+    // Grow the last slice if it is into this chunk and ends right where these
+    // bytes begin, so a run of small writes stays a single Buffer.
+    const char *tail = _chunk->data() + _chunk_used;
+    if (!_buffers.empty() && _buffers.back().storage() == _chunk &&
+        _buffers.back().str().data() + _buffers.back().size() == tail) {
+        const size_t offset = _buffers.back().str().data() - _chunk->data();
+        _buffers.back() = Buffer{_chunk, offset, _buffers.back().size() + len};
+    } else {
+        _buffers.push_back(Buffer{_chunk, _chunk_used, len});
+    }
+    _chunk_used += len;
+    _size += len;
+    _peak_size = std::max(_peak_size, _size);
+    _write_bytes_count += len;
+}
+
+//! \param[in] len the maximum number of bytes the writer wants to place
+//! \details The first region is whatever is left of the current chunk; the
+//! second, if needed, is a fresh chunk that becomes current on commit().
+vector<iovec> ByteStream::writable_spans(const size_t len) {
+    vector<iovec> spans{};
+    _writable = input_ended() ? 0 : std::min(len, remaining_capacity());
+    if (_writable == 0) {
+        return spans;
+    }
+
+    char *tail = chunk_tail();
+    const size_t first = std::min(_writable, _chunk->size() - _chunk_used);
+    spans.push_back({tail, first});
+
+    if (_writable > first) {
+        if (!_next_chunk) {
+            _next_chunk = new_chunk();
+        }
+        const size_t second = std::min(_writable - first, _next_chunk->size());
+        spans.push_back({_next_chunk->data(), second});
+        _writable = first + second;
+    }
+    return spans;
+}
+
+//! \param[in] len the number of bytes the writer actually placed in the spans
+void ByteStream::commit(const size_t len) {
+    if (len > _writable) {
+        throw runtime_error("ByteStream::commit() beyond the regions from writable_spans()");
+    }
+    _writable = 0;
+    // nothing was placed (e.g. read_from() hit EOF): publish no empty slice, and don't
+    // keep chunks that writable_spans() allocated for an empty stream
+    if (len == 0) {
+        if (_size == 0) {
+            release_chunks();
+        }
+        return;
+    }
+    const size_t first = std::min(len, _chunk->size() - _chunk_used);
+    publish(first);
+    if (len > first) {
+        // the second span lives in `_next_chunk`, which becomes current here
+        chunk_tail();
+        publish(len - first);
+    }
+}
+
+//! \param[in] fd the descriptor to read from
+//! \param[in] len the maximum number of bytes to read
+//! \details The bytes are scattered by one [readv(2)](\ref man2::readv)
+//! into the regions from writable_spans(), so nothing is copied twice.
+size_t ByteStream::read_from(FileDescriptor &fd, const size_t len) {
+    const auto spans = writable_spans(len);
+    if (spans.empty()) {
+        return 0;
+    }
+    const size_t bytes_read = fd.read(spans);
+    commit(bytes_read);
+    return bytes_read;
+}
+
 //! \param[in] len bytes will be copied from the output side of the buffer
 string ByteStream::peek_output(const size_t len) const {
     std::string str{};
     const size_t length = std::min(len, buffer_size());
-    for (size_t i = 0; i < length; ++i) {
-        str.push_back(ringBuffer[(i + _read_ptr) % _capacity]);
+    str.reserve(length);
+    for (const auto &buf : _buffers) {
+        if (str.size() == length) {
+            break;
+        }
+        str.append(buf.str().substr(0, length - str.size()));
     }
     return str;
 }
 
+//! \param[in] len bytes will be viewed from the output side of the buffer
+BufferViewList ByteStream::peek(const size_t len) const {
+    // The slices share their storage with `_buffers`, so the views
+    // stay valid after `prefix` itself goes away.
+    BufferList prefix{};
+    size_t length = std::min(len, buffer_size());
+    for (const auto &buf : _buffers) {
+        if (length == 0) {
+            break;
+        }
+        Buffer slice = buf;
+        if (slice.size() > length) {
+            slice.remove_suffix(slice.size() - length);
+        }
+        length -= slice.size();
+        prefix.append(move(slice));
+    }
+    return prefix;
+}
+
 //! \param[in] len bytes will be removed from the output side of the buffer
 void ByteStream::pop_output(const size_t len) {
     const size_t length = std::min(len, buffer_size());
-    advance_read(length);
+    size_t remaining = length;
+    while (remaining > 0) {
+        if (remaining < _buffers.front().size()) {
+            _buffers.front().remove_prefix(remaining);
+            break;
+        }
+        remaining -= _buffers.front().size();
+        _buffers.pop_front();
+    }
     _size -= length;
     _read_bytes_count += length;
+
+    // Let go of the chunks once drained (unless writable_spans() handed them out).
+    if (_size == 0 && _writable == 0) {
+        release_chunks();
+    }
+}
+
+void ByteStream::release_chunks() {
+    _chunk.reset();
+    _chunk_used = 0;
+    _next_chunk.reset();
+    _next_chunk_size = MIN_CHUNK_SIZE;
+    while (_next_chunk_size < std::min(_peak_size, CHUNK_SIZE)) {
+        _next_chunk_size *= 2;
+    }
+    _peak_size = 0;
 }
 
 //! Read (i.e., copy and then pop) the next "len" bytes of the stream
@@ -47,6 +218,39 @@ std::string ByteStream::read(const size_t len) {
     return str;
 }
 
+//! \param[in] len bytes will be popped and returned
+//! \details The stored bytes are never modified once written, so the slice
+//! stays valid after they are popped. Bytes that span two stored Buffers are
+//! copied into a new one.
+Buffer ByteStream::read_buffer(const size_t len) {
+    const size_t length = std::min(len, buffer_size());
+    if (length == 0) {
+        return {};
+    }
+    Buffer slice = _buffers.front();
+    if (slice.size() >= length) {
+        slice.remove_suffix(slice.size() - length);
+    } else {
+        slice = Buffer{peek_output(length)};
+    }
+    pop_output(length);
+    return slice;
+}
+
+//! \param[in] fd the descriptor to write to
+//! \param[in] len the maximum number of bytes to write
+//! \details The stored Buffers are gathered by [writev(2)](\ref man2::writev),
+//! and only what was actually written is popped.
+size_t ByteStream::write_to(FileDescriptor &fd, const size_t len) {
+    const size_t length = std::min(len, buffer_size());
+    if (length == 0) {
+        return 0;
+    }
+    const size_t bytes_written = fd.write(peek(length), false);
+    pop_output(bytes_written);
+    return bytes_written;
+}
+
 void ByteStream::end_input() { _input_end = true; }
 
 bool ByteStream::input_ended() const { return _input_end; }
@@ -1,27 +1,66 @@
 #ifndef SPONGE_LIBSPONGE_BYTE_STREAM_HH
 #define SPONGE_LIBSPONGE_BYTE_STREAM_HH
 
+#include "buffer.hh"
+
+#include <deque>
+#include <memory>
 #include <string>
+#include <sys/uio.h>
 #include <vector>
 
+class FileDescriptor;
+
 //! \brief An in-order byte stream.
 
 //! Bytes are written on the "input" side and read from the "output"
 //! side.  The byte stream is finite: the writer can end the input,
 //! and then no more bytes can be written.
+//!
+//! The unread bytes are kept as a chain of reference-counted Buffer
+//! slices, so a Buffer written into the stream is never copied, and
+//! peek() hands out views of the same storage. Copied writes are packed
+//! into shared chunks, so small writes don't each allocate.
+//!
+//! Nothing is allocated up front: chunks start small and double while
+//! the stream keeps filling, and are let go once it drains, so an idle
+//! stream holds no memory. After a drain, the first chunk is sized for
+//! the burst that was just drained. The chunks are charged to the
+//! process-wide MemoryBudget.
 class ByteStream {
   private:
-    int _capacity;                   //!< the capacity of the ByteStream.
-    std::vector<char> ringBuffer{};  //!< the ringBuffer.
-    size_t _write_ptr = 0;           //!< the write pointer.
-    size_t _read_ptr = 0;            //!< the read pointer.
-    size_t _write_bytes_count = 0;   //!< record how many bytes are written.
-    size_t _read_bytes_count = 0;    //!< record how many bytes are read.
-    size_t _size = 0;                //!< the current size of the ringBuffer
-    bool _input_end = false;         //!< whether the writing should be end
-    bool _error = false;             //!< Flag indicating that the stream suffered an error.
-    void advance_write(size_t size) { _write_ptr = (_write_ptr + size) % _capacity; }
-    void advance_read(size_t size) { _read_ptr = (_read_ptr + size) % _capacity; }
+    //! the size of the first chunk after the stream (re)starts
+    static constexpr size_t MIN_CHUNK_SIZE = 1 << 12;
+
+    //! the largest chunk that copied writes are packed into
+    static constexpr size_t CHUNK_SIZE = 1 << 16;
+
+    size_t _capacity;                            //!< the capacity of the ByteStream.
+    std::deque<Buffer> _buffers{};               //!< the chain of Buffer slices holding the unread bytes.
+    std::shared_ptr<std::string> _chunk{};       //!< the chunk that copied writes are packed into
+    size_t _chunk_used = 0;                      //!< the number of bytes of `_chunk` already published
+    std::shared_ptr<std::string> _next_chunk{};  //!< the chunk behind the second writable span
+    size_t _next_chunk_size = MIN_CHUNK_SIZE;    //!< the size of the next chunk to allocate
+    size_t _peak_size = 0;                       //!< the most unread bytes since the stream last drained
+    size_t _writable = 0;                        //!< the number of bytes offered by writable_spans()
+    size_t _write_bytes_count = 0;               //!< record how many bytes are written.
+    size_t _read_bytes_count = 0;                //!< record how many bytes are read.
+    size_t _size = 0;                            //!< the current number of unread bytes
+    bool _input_end = false;                     //!< whether the writing should be end
+    bool _error = false;                         //!< Flag indicating that the stream suffered an error.
+
+    //! Make sure the current chunk has room left, starting a new one if needed
+    //! \returns the first free byte of the current chunk
+    char *chunk_tail();
+
+    //! Make `len` bytes at the tail of the current chunk readable
+    void publish(const size_t len);
+
+    //! Allocate the next chunk, doubling the size for the one after
+    std::shared_ptr<std::string> new_chunk();
+
+    //! Let go of both chunks once the stream is empty, and size the next one for the burst just drained
+    void release_chunks();
 
   public:
     //! Construct a stream with room for `capacity` bytes.
@@ -35,6 +74,23 @@ class ByteStream {
     //! \returns the number of bytes accepted into the stream
     size_t write(const std::string &data);
 
+    //! Write a Buffer into the stream without copying its bytes. Write as many
+    //! as will fit, and return how many were written.
+    //! \returns the number of bytes accepted into the stream
+    size_t write(Buffer data);
+
+    //! Expose the regions where the next (at most) `len` bytes can be written in place,
+    //! e.g. by [readv(2)](\ref man2::readv); they become readable once passed to commit().
+    //! \returns at most two regions: the rest of the current chunk, then a fresh one
+    std::vector<iovec> writable_spans(const size_t len);
+
+    //! Publish the first `len` bytes of the regions returned by writable_spans()
+    void commit(const size_t len);
+
+    //! Read (at most) `len` bytes from `fd` straight into the stream's free space
+    //! \returns the number of bytes read (and written into the stream)
+    size_t read_from(FileDescriptor &fd, const size_t len);
+
     //! \returns the number of additional bytes that the stream has space for
     size_t remaining_capacity() const;
 
@@ -52,6 +108,10 @@ class ByteStream {
     //! \returns a string
     std::string peek_output(const size_t len) const;
 
+    //! Peek at next "len" bytes of the stream without copying them
+    //! \returns views of the stored Buffers, valid until the bytes are popped
+    BufferViewList peek(const size_t len) const;
+
     //! Remove bytes from the buffer
     void pop_output(const size_t len);
 
@@ -59,6 +119,14 @@ class ByteStream {
     //! \returns a string
     std::string read(const size_t len);
 
+    //! Read (i.e., slice and then pop) the next "len" bytes of the stream
+    //! \returns a Buffer sharing the stream's storage, unless the bytes span more than one stored Buffer
+    Buffer read_buffer(const size_t len);
+
+    //! Write (at most) the next `len` bytes of the stream to `fd` without blocking, and pop them
+    //! \returns the number of bytes written (and popped)
+    size_t write_to(FileDescriptor &fd, const size_t len);
+
     //! \returns `true` if the stream input has ended
     bool input_ended() const;
 
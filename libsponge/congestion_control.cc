@@ -0,0 +1,271 @@
+#include "congestion_control.hh"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+
+using namespace std;
+
+//! \param[in] algorithm the algorithm to run
+//! \param[in] mss the largest payload the sender puts in a segment
+unique_ptr<CongestionController> make_congestion_controller(const CongestionControl algorithm, const size_t mss) {
+    switch (algorithm) {
+        case CongestionControl::newreno:
+            return make_unique<NewReno>(mss);
+        case CongestionControl::cubic:
+            return make_unique<Cubic>(mss);
+        case CongestionControl::bbr:
+            return make_unique<BBR>(mss);
+        case CongestionControl::none:
+            break;
+    }
+    return nullptr;
+}
+
+namespace {
+
+//! The initial window from [RFC 6928](\ref rfc::rfc6928): ten segments, but no more than 14600 bytes
+size_t initial_window(const size_t mss) { return min(10 * mss, max(2 * mss, size_t{14600})); }
+
+}  // namespace
+
+NewReno::NewReno(const size_t mss)
+    : CongestionController(mss), _cwnd(initial_window(mss)), _ssthresh(numeric_limits<size_t>::max()) {}
+
+//! \details Slow start counts the acknowledged bytes, up to two segments per ACK
+//! ([RFC 3465](\ref rfc::rfc3465)); congestion avoidance adds one segment for each
+//! window's worth of acknowledged bytes.
+void NewReno::on_ack(const AckSample &sample) {
+    // the window stays at ssthresh until the recovery is over
+    if (sample.in_recovery) {
+        return;
+    }
+    if (_cwnd < _ssthresh) {
+        _cwnd += min(sample.acked, 2 * _mss);
+        return;
+    }
+    _acked_in_avoidance += sample.acked;
+    if (_acked_in_avoidance >= _cwnd) {
+        _acked_in_avoidance -= _cwnd;
+        _cwnd += _mss;
+    }
+}
+
+void NewReno::on_loss(const uint64_t, const size_t bytes_in_flight) {
+    _ssthresh = max(bytes_in_flight / 2, 2 * _mss);
+    _cwnd = _ssthresh;
+    _acked_in_avoidance = 0;
+}
+
+void NewReno::on_timeout(const uint64_t, const size_t bytes_in_flight) {
+    _ssthresh = max(bytes_in_flight / 2, 2 * _mss);
+    _cwnd = _mss;
+    _acked_in_avoidance = 0;
+}
+
+Cubic::Cubic(const size_t mss)
+    : CongestionController(mss), _cwnd(initial_window(mss)), _ssthresh(numeric_limits<double>::max()) {}
+
+//! \details In congestion avoidance the window moves toward
+//! W(t) = C * (t - K)^3 + W_max, with t measured one minimum RTT ahead, but never
+//! falls below the window standard TCP would have reached in the same epoch.
+void Cubic::on_ack(const AckSample &sample) {
+    if (sample.rtt.has_value()) {
+        _min_rtt = min(_min_rtt.value_or(*sample.rtt), *sample.rtt);
+    }
+    if (sample.in_recovery) {
+        return;
+    }
+    const double acked = static_cast<double>(sample.acked);
+    const double mss = static_cast<double>(_mss);
+
+    if (_cwnd < _ssthresh) {
+        _cwnd += min(acked, 2 * mss);
+        return;
+    }
+
+    if (not _epoch.has_value()) {
+        _epoch = sample.now;
+        if (_cwnd < _w_max) {
+            _k = cbrt((_w_max - _cwnd) / mss / C);
+            _origin = _w_max;
+        } else {
+            _k = 0;
+            _origin = _cwnd;
+        }
+        _w_est = _cwnd;
+    }
+
+    const double t = static_cast<double>(sample.now + _min_rtt.value_or(0) - *_epoch) / 1000.0;
+    const double target = min(_origin + C * pow(t - _k, 3) * mss, 1.5 * _cwnd);
+    if (target > _cwnd) {
+        _cwnd += (target - _cwnd) * acked / _cwnd;
+    } else {
+        _cwnd += 0.01 * mss * acked / _cwnd;
+    }
+
+    _w_est += 3 * (1 - BETA) / (1 + BETA) * mss * acked / _cwnd;
+    _cwnd = max(_cwnd, _w_est);
+}
+
+//! \details With fast convergence, a flow that is shrinking below its previous
+//! maximum releases bandwidth by aiming lower than where it lost.
+void Cubic::reduce() {
+    _epoch.reset();
+    _w_max = _cwnd < _w_max ? _cwnd * (1 + BETA) / 2 : _cwnd;
+    _ssthresh = max(_cwnd * BETA, 2.0 * static_cast<double>(_mss));
+}
+
+void Cubic::on_loss(const uint64_t, const size_t) {
+    reduce();
+    _cwnd = _ssthresh;
+}
+
+void Cubic::on_timeout(const uint64_t, const size_t) {
+    reduce();
+    _cwnd = static_cast<double>(_mss);
+}
+
+namespace {
+
+//! The pacing gains of the probe_bw phases: probe for more bandwidth, drain the queue that built, then cruise
+constexpr array<double, 8> PROBE_BW_GAINS{1.25, 0.75, 1, 1, 1, 1, 1, 1};
+
+}  // namespace
+
+BBR::BBR(const size_t mss) : CongestionController(mss), _cwnd(initial_window(mss)) {}
+
+size_t BBR::target_cwnd(const double gain) const {
+    const size_t min_cwnd = MIN_CWND_SEGMENTS * _mss;
+    if (_bw.empty() or not _min_rtt.has_value()) {
+        return max(initial_window(_mss), min_cwnd);
+    }
+    const double bdp = bottleneck_bandwidth() * static_cast<double>(max(*_min_rtt, uint64_t{1}));
+    return max(static_cast<size_t>(gain * bdp), min_cwnd);
+}
+
+//! \details A round trip ends once a minimum RTT has passed since it started; the
+//! bytes acknowledged during it give one delivery rate sample.
+void BBR::update_model(const AckSample &sample) {
+    if (sample.rtt.has_value() and
+        (not _min_rtt.has_value() or *sample.rtt <= *_min_rtt or sample.now > _min_rtt_stamp + MIN_RTT_WINDOW)) {
+        _min_rtt = sample.rtt;
+        _min_rtt_stamp = sample.now;
+    }
+
+    _round_delivered += sample.acked;
+    const uint64_t elapsed = sample.now - _round_start;
+    if (not _min_rtt.has_value() or elapsed == 0 or elapsed < *_min_rtt) {
+        return;
+    }
+
+    const double bw = static_cast<double>(_round_delivered) / static_cast<double>(elapsed);
+    _round++;
+    _round_start = sample.now;
+    _round_delivered = 0;
+
+    while (not _bw.empty() and _bw.back().second <= bw) {
+        _bw.pop_back();
+    }
+    _bw.emplace_back(_round, bw);
+    while (_bw.front().first + BW_WINDOW_ROUNDS <= _round) {
+        _bw.pop_front();
+    }
+
+    // startup ends when three rounds in a row fail to grow the bandwidth by a quarter
+    if (not _filled_pipe) {
+        if (bottleneck_bandwidth() >= _full_bw * 1.25) {
+            _full_bw = bottleneck_bandwidth();
+            _full_bw_rounds = 0;
+        } else if (++_full_bw_rounds >= 3) {
+            _filled_pipe = true;
+        }
+    }
+}
+
+void BBR::enter_probe_bw(const uint64_t now) {
+    _mode = Mode::probe_bw;
+    _cwnd_gain = 2;
+    _cycle_index = 0;
+    _cycle_stamp = now;
+    _pacing_gain = PROBE_BW_GAINS.at(_cycle_index);
+}
+
+void BBR::update_mode(const AckSample &sample) {
+    if (_mode == Mode::startup and _filled_pipe) {
+        _mode = Mode::drain;
+        _pacing_gain = 1 / HIGH_GAIN;
+        _cwnd_gain = HIGH_GAIN;
+    }
+    if (_mode == Mode::drain and sample.bytes_in_flight <= target_cwnd(1)) {
+        enter_probe_bw(sample.now);
+    }
+    if (_mode == Mode::probe_bw and sample.now - _cycle_stamp > _min_rtt.value_or(0)) {
+        _cycle_index = (_cycle_index + 1) % PROBE_BW_GAINS.size();
+        _cycle_stamp = sample.now;
+        _pacing_gain = PROBE_BW_GAINS.at(_cycle_index);
+    }
+
+    // an old minimum RTT is re-measured by briefly draining the path
+    if (_mode != Mode::probe_rtt and _min_rtt.has_value() and sample.now > _min_rtt_stamp + MIN_RTT_WINDOW) {
+        _mode = Mode::probe_rtt;
+        _pacing_gain = 1;
+        _cwnd_gain = 1;
+        _prior_cwnd = max(_prior_cwnd, _cwnd);
+        _probe_rtt_done = sample.now + PROBE_RTT_DURATION;
+    }
+    if (_mode == Mode::probe_rtt and sample.now >= _probe_rtt_done.value_or(0)) {
+        _min_rtt_stamp = sample.now;
+        _probe_rtt_done.reset();
+        _cwnd = max(_cwnd, _prior_cwnd);
+        _prior_cwnd = 0;
+        if (_filled_pipe) {
+            enter_probe_bw(sample.now);
+        } else {
+            _mode = Mode::startup;
+            _pacing_gain = HIGH_GAIN;
+            _cwnd_gain = HIGH_GAIN;
+        }
+    }
+}
+
+//! \details The window grows by the acknowledged bytes until it reaches the
+//! model's target; before the pipe is filled it only grows.
+void BBR::on_ack(const AckSample &sample) {
+    update_model(sample);
+    update_mode(sample);
+
+    const size_t target = target_cwnd(_cwnd_gain);
+    if (_filled_pipe) {
+        _cwnd = min(_cwnd + sample.acked, target);
+    } else if (_cwnd < target or _bw.empty()) {
+        _cwnd += sample.acked;
+    }
+    if (_prior_cwnd != 0 and _mode != Mode::probe_rtt) {
+        _cwnd = max(_cwnd, min(_prior_cwnd, target));
+        _prior_cwnd = 0;
+    }
+    _cwnd = max(_cwnd, MIN_CWND_SEGMENTS * _mss);
+    if (_mode == Mode::probe_rtt) {
+        _cwnd = min(_cwnd, MIN_CWND_SEGMENTS * _mss);
+    }
+}
+
+//! \details Loss is not a signal to BBR: the window only stops growing past
+//! what is already in flight (packet conservation) until new ACKs arrive.
+void BBR::on_loss(const uint64_t, const size_t bytes_in_flight) {
+    _cwnd = max(min(_cwnd, bytes_in_flight), MIN_CWND_SEGMENTS * _mss);
+}
+
+void BBR::on_timeout(const uint64_t, const size_t) {
+    _prior_cwnd = max(_prior_cwnd, _cwnd);
+    _cwnd = _mss;
+}
+
+optional<double> BBR::pacing_rate() const {
+    if (_bw.empty()) {
+        return {};
+    }
+    return _pacing_gain * bottleneck_bandwidth();
+}
@@ -0,0 +1,178 @@
+#ifndef SPONGE_LIBSPONGE_CONGESTION_CONTROL_HH
+#define SPONGE_LIBSPONGE_CONGESTION_CONTROL_HH
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+
+//! The congestion control algorithms a TCPSender can use
+enum class CongestionControl { none, newreno, cubic, bbr };
+
+//! \brief What the TCPSender learned from an acknowledgment of new data
+struct AckSample {
+    uint64_t now;                   //!< the sender's clock, in milliseconds
+    size_t acked;                   //!< the sequence numbers newly acknowledged
+    size_t bytes_in_flight;         //!< the sequence numbers still outstanding after the ACK
+    std::optional<uint64_t> rtt{};  //!< the RTT of the newest acknowledged segment, unless any were resent
+    bool in_recovery{false};        //!< whether the ACK arrived during a recovery from a fast retransmit
+};
+
+//! \brief The interface between a TCPSender and a congestion control algorithm.
+
+//! The sender reports every acknowledgment of new data (with an RTT sample
+//! when Karn's rule allows one), every loss it detects, and every
+//! retransmission timeout. In return the controller sets the congestion
+//! window, which the sender combines with the receiver's window, and
+//! optionally the rate at which segments should be paced out.
+class CongestionController {
+  protected:
+    size_t _mss;  //!< the largest payload the sender puts in a segment
+
+  public:
+    //! Create a controller for segments of at most `mss` bytes
+    explicit CongestionController(const size_t mss) : _mss(mss) {}
+    virtual ~CongestionController() = default;
+
+    //! \brief New data was acknowledged
+    virtual void on_ack(const AckSample &sample) = 0;
+
+    //! \brief A segment was found lost while others still arrive (e.g. from duplicate ACKs)
+    virtual void on_loss(const uint64_t now, const size_t bytes_in_flight) = 0;
+
+    //! \brief The retransmission timer expired
+    virtual void on_timeout(const uint64_t now, const size_t bytes_in_flight) = 0;
+
+    //! \returns the congestion window, in bytes
+    virtual size_t cwnd() const = 0;
+
+    //! \returns the rate at which to pace segments, in bytes per millisecond, if the algorithm paces
+    virtual std::optional<double> pacing_rate() const { return {}; }
+
+    //! \returns the name of the algorithm
+    virtual std::string name() const = 0;
+
+    //! \name
+    //! A controller belongs to a single sender
+
+    //!@{
+    CongestionController(const CongestionController &other) = delete;
+    CongestionController &operator=(const CongestionController &other) = delete;
+    //!@}
+};
+
+//! \brief Create a controller running `algorithm`, or nullptr for CongestionControl::none
+std::unique_ptr<CongestionController> make_congestion_controller(const CongestionControl algorithm, const size_t mss);
+
+//! \brief [NewReno](\ref rfc::rfc5681): slow start, then one MSS per round trip, halving on loss
+class NewReno : public CongestionController {
+  private:
+    size_t _cwnd;                  //!< the congestion window
+    size_t _ssthresh;              //!< the slow start threshold
+    size_t _acked_in_avoidance{};  //!< bytes acknowledged toward the next congestion avoidance increase
+
+  public:
+    explicit NewReno(const size_t mss);
+
+    void on_ack(const AckSample &sample) override;
+    void on_loss(const uint64_t now, const size_t bytes_in_flight) override;
+    void on_timeout(const uint64_t now, const size_t bytes_in_flight) override;
+    size_t cwnd() const override { return _cwnd; }
+    size_t ssthresh() const { return _ssthresh; }
+    std::string name() const override { return "newreno"; }
+};
+
+//! \brief [CUBIC](\ref rfc::rfc8312): a window that grows as a cubic function of the time since the last loss
+class Cubic : public CongestionController {
+  private:
+    static constexpr double C = 0.4;     //!< the scaling constant of the cubic function
+    static constexpr double BETA = 0.7;  //!< the multiplicative decrease factor
+
+    double _cwnd;                        //!< the congestion window, in bytes
+    double _ssthresh;                    //!< the slow start threshold, in bytes
+    double _w_max{0};                    //!< the window just before the last reduction
+    double _w_est{0};                    //!< the window standard TCP would have reached in the epoch
+    double _k{0};                        //!< the seconds the cubic function takes to return to its origin
+    double _origin{0};                   //!< the window at the plateau of the cubic function
+    std::optional<uint64_t> _epoch{};    //!< when the current congestion avoidance epoch started
+    std::optional<uint64_t> _min_rtt{};  //!< the smallest RTT seen
+
+    //! Shrink the window's targets after a congestion event
+    void reduce();
+
+  public:
+    explicit Cubic(const size_t mss);
+
+    void on_ack(const AckSample &sample) override;
+    void on_loss(const uint64_t now, const size_t bytes_in_flight) override;
+    void on_timeout(const uint64_t now, const size_t bytes_in_flight) override;
+    size_t cwnd() const override { return static_cast<size_t>(_cwnd); }
+    size_t ssthresh() const { return static_cast<size_t>(_ssthresh); }
+    std::string name() const override { return "cubic"; }
+};
+
+//! \brief BBR (version 1): a model of the path's bottleneck bandwidth and round-trip propagation time
+
+//! The window and pacing rate follow the model instead of reacting to
+//! loss: the controller probes for bandwidth with a pacing gain above one,
+//! drains the queue it built with a gain below one, and periodically
+//! shrinks the window to re-measure the minimum RTT.
+class BBR : public CongestionController {
+  public:
+    enum class Mode { startup, drain, probe_bw, probe_rtt };
+
+  private:
+    static constexpr double HIGH_GAIN = 2.885;           //!< 2/ln(2), doubling the rate each round in startup
+    static constexpr size_t BW_WINDOW_ROUNDS = 10;       //!< rounds covered by the bandwidth max filter
+    static constexpr uint64_t MIN_RTT_WINDOW = 10000;    //!< milliseconds a minimum RTT sample stays valid
+    static constexpr uint64_t PROBE_RTT_DURATION = 200;  //!< milliseconds spent in probe_rtt
+    static constexpr size_t MIN_CWND_SEGMENTS = 4;       //!< the smallest window, in segments
+
+    Mode _mode{Mode::startup};
+    double _pacing_gain{HIGH_GAIN};
+    double _cwnd_gain{HIGH_GAIN};
+    size_t _cwnd;                                   //!< the congestion window
+    size_t _prior_cwnd{0};                          //!< the window to restore after probe_rtt or a timeout
+    std::deque<std::pair<uint64_t, double>> _bw{};  //!< max filter of (round, bytes per millisecond) samples
+    std::optional<uint64_t> _min_rtt{};             //!< the round-trip propagation time estimate
+    uint64_t _min_rtt_stamp{0};                     //!< when _min_rtt was measured
+    uint64_t _round{0};                             //!< the number of round trips so far
+    uint64_t _round_start{0};                       //!< when the current round trip started
+    size_t _round_delivered{0};                     //!< bytes acknowledged in the current round trip
+    double _full_bw{0};                             //!< the bandwidth when startup last saw it grow
+    size_t _full_bw_rounds{0};                      //!< rounds since the bandwidth last grew by a quarter
+    bool _filled_pipe{false};                       //!< whether startup found the bottleneck bandwidth
+    size_t _cycle_index{0};                         //!< the current phase of the probe_bw gain cycle
+    uint64_t _cycle_stamp{0};                       //!< when the current phase started
+    std::optional<uint64_t> _probe_rtt_done{};      //!< when probe_rtt ends
+
+    //! The bandwidth-delay product scaled by `gain`, or the initial window without a model yet
+    size_t target_cwnd(const double gain) const;
+
+    void update_model(const AckSample &sample);
+    void update_mode(const AckSample &sample);
+    void enter_probe_bw(const uint64_t now);
+
+  public:
+    explicit BBR(const size_t mss);
+
+    void on_ack(const AckSample &sample) override;
+    void on_loss(const uint64_t now, const size_t bytes_in_flight) override;
+    void on_timeout(const uint64_t now, const size_t bytes_in_flight) override;
+    size_t cwnd() const override { return _cwnd; }
+    std::optional<double> pacing_rate() const override;
+    std::string name() const override { return "bbr"; }
+
+    //! \returns the estimated bottleneck bandwidth, in bytes per millisecond
+    double bottleneck_bandwidth() const { return _bw.empty() ? 0 : _bw.front().second; }
+
+    //! \returns the estimated round-trip propagation time, in milliseconds
+    std::optional<uint64_t> min_rtt() const { return _min_rtt; }
+
+    Mode mode() const { return _mode; }
+};
+
+#endif  // SPONGE_LIBSPONGE_CONGESTION_CONTROL_HH
@@ -1,7 +1,23 @@
 #include "retransmission_timer.hh"
 
+#include <algorithm>
+#include <cmath>
+
 RetransmissionTimer::RetransmissionTimer(const size_t retx_timeout)
-    : state{TimerState::stop}, _initial_rto{retx_timeout}, _rto{retx_timeout} {}
+    : state{TimerState::stop}
+    , _initial_rto{retx_timeout}
+    , _rto{retx_timeout}
+    , _adaptive{false}
+    , _min_rto{0}
+    , _max_rto{retx_timeout} {}
+
+RetransmissionTimer::RetransmissionTimer(const size_t retx_timeout, const size_t min_rto, const size_t max_rto)
+    : state{TimerState::stop}
+    , _initial_rto{retx_timeout}
+    , _rto{retx_timeout}
+    , _adaptive{true}
+    , _min_rto{min_rto}
+    , _max_rto{max_rto} {}
 
 bool RetransmissionTimer::tick_callback(const size_t ms_since_last_tick) {
     //! Only when the timer is running, we add the `_accumulate_time`.
@@ -33,5 +49,28 @@ void RetransmissionTimer::stop_timer() {
 
 void RetransmissionTimer::handle_expired() {
     _rto *= 2;
+    //! Without RTT estimation the backoff is unbounded, as it always was.
+    if (_adaptive) {
+        _rto = std::min(_rto, _max_rto);
+    }
     _accumulate_time = 0;
 }
+
+//! RFC 6298: SRTT and RTTVAR are exponentially weighted averages (with gains of 1/8 and 1/4)
+//! and the timeout is SRTT + 4 * RTTVAR, rounded up to the next millisecond.
+//! The new timeout takes effect the next time the timer is reset, which also clears any backoff.
+void RetransmissionTimer::rtt_sample(const size_t rtt) {
+    const double sample = static_cast<double>(rtt);
+    if (!_srtt.has_value()) {
+        _srtt = sample;
+        _rttvar = sample / 2;
+    } else {
+        _rttvar = 0.75 * _rttvar + 0.25 * std::abs(*_srtt - sample);
+        _srtt = 0.875 * *_srtt + 0.125 * sample;
+    }
+    if (!_adaptive) {
+        return;
+    }
+    const size_t rto = static_cast<size_t>(std::ceil(*_srtt + std::max(1.0, 4 * _rttvar)));
+    _initial_rto = std::clamp(rto, _min_rto, _max_rto);
+}
@@ -2,19 +2,29 @@
 #define SPONGE_LIBSPONGE_RETRANSMISSION_TIMER
 
 #include <cstddef>
+#include <optional>
 
 enum class TimerState { running, stop };
 
 class RetransmissionTimer {
   private:
-    TimerState state;             //! the state of the timer
-    size_t _initial_rto;          //! the initial retransmission timeout
-    size_t _rto;                  //! current retransmission timeout
-    size_t _accumulate_time = 0;  //! the accumulate time
+    TimerState state;               //! the state of the timer
+    size_t _initial_rto;            //! the initial retransmission timeout
+    size_t _rto;                    //! current retransmission timeout
+    size_t _accumulate_time = 0;    //! the accumulate time
+    bool _adaptive;                 //! whether RTT samples set the timeout
+    size_t _min_rto;                //! the smallest timeout RTT samples may set
+    size_t _max_rto;                //! the largest timeout, even after backing off
+    std::optional<double> _srtt{};  //! the smoothed round-trip time
+    double _rttvar = 0;             //! the round-trip time variation
+
   public:
     //! \brief constructor
     RetransmissionTimer(const size_t retx_timeout);
 
+    //! \brief constructor for a timer whose timeout follows the measured RTT, within [min_rto, max_rto]
+    RetransmissionTimer(const size_t retx_timeout, const size_t min_rto, const size_t max_rto);
+
     //! \brief check whether the time is expired
     bool tick_callback(const size_t ms_since_last_tick);
 
@@ -29,6 +39,15 @@ class RetransmissionTimer {
 
     //! \brief stop the timer
     void stop_timer();
+
+    //! \brief update the RTT estimate with the RTT of a segment that was sent only once (and, if adaptive, the timeout)
+    void rtt_sample(const size_t rtt);
+
+    //! \brief the current retransmission timeout
+    size_t rto() const { return _rto; }
+
+    //! \brief the smoothed round-trip time, once there has been a sample
+    std::optional<double> srtt() const { return _srtt; }
 };
 
 #endif  // SPONGE_LIBSPONGE_RETRANSMISSION_TIMER
@@ -1,86 +1,188 @@
 #include "stream_reassembler.hh"
 
+#include "memory_budget.hh"
+
+#include <algorithm>
+#include <iterator>
+
 using namespace std;
 
-StreamReassembler::StreamReassembler(const size_t capacity) : _output(capacity), _capacity(capacity) {
-    _stream.resize(capacity, 0);
-    _dirty.resize(capacity, false);
-}
+StreamReassembler::StreamReassembler(const size_t capacity) : _output(capacity), _capacity(capacity) {}
 
 //! \details This function accepts a substring (aka a segment) of bytes,
 //! possibly out-of-order, from the logical stream, and assembles any newly
 //! contiguous substrings and writes them into the output stream in order.
 void StreamReassembler::push_substring(const string &data, const size_t index, const bool eof) {
+    push_substring(Buffer{string(data)}, index, eof);
+}
+
+//! \details Same as the std::string version, but the slices that are stored
+//! (or written to the output stream) share `data`'s storage instead of copying it.
+//! That storage is charged to the MemoryBudget for as long as any slice holds it.
+void StreamReassembler::push_substring(const Buffer &received, const size_t index, const bool eof) {
     // When the string is out of the `_next_index+_capacity` or the end of the string
     // is before the `_next_index`, we should do NOTHING.
-    if (index >= _capacity + _next_index || _next_index > index + data.size())
+    const size_t window_end = _next_index + _capacity;
+    if (index >= window_end || _next_index > index + received.size()) {
         return;
+    }
+    const Buffer data = MemoryBudget::global().adopt(received);
 
-    // Here we should consider the situation that we should accept part of
-    // the string, when `actual_index < _next_index`. We should set the `actual_index`
-    // to be the `_next_index` to drop the previous string, and make `data_index`
-    // to be the `_next_index-index`.
-    size_t actual_index = index;
-    size_t data_index = 0;
-    if (index < _next_index) {
-        actual_index = _next_index;
-        data_index += _next_index - index;
-    }
-
-    // Here we need to find the start index and loop index
-    size_t start_index = _next_index % _capacity;
-    size_t loop_index = actual_index % _capacity;
-
-    // Corner case: when the data is empty. This is important
-    // Because the below iteration does not consider
-    if (data.empty()) {
-        if (eof) {
-            _should_eof = true;
-        }
+    // We only know where the stream ends if its last byte fits in the window.
+    if (eof && index + data.size() <= window_end) {
+        _eof_index = index + data.size();
     }
 
-    // Here, when `_dirty[index] == false` We store the byte into
-    // the `_stream[index]` and set the `_dirty[index]` to be true.
-    for (size_t i = loop_index, j = data_index; j < data.size(); i = next(i), j++) {
-        if (!_dirty[i]) {
-            _stream[i] = data[j];
-            _unassembly++;
-            _dirty[i] = true;
-        }
-        if (j + 1 == data.size()) {
-            if (eof) {
-                _should_eof = true;
-            }
+    // Fast path: nothing is stored and the substring starts at (or before) the
+    // next index, so if it fits, it can go straight into the output stream.
+    if (_pending.empty() && index <= _next_index &&
+        index + data.size() - _next_index <= stream_out().remaining_capacity()) {
+        _stats.fast_path++;
+        Buffer slice = data;
+        slice.remove_prefix(_next_index - index);
+        if (slice.size() > 0) {
+            _next_index += stream_out().write(move(slice));
         }
+    } else {
+        _stats.slow_path++;
+        store(data, index);
+        flush();
+    }
 
-        if (next(i) == start_index)
-            break;
+    if (_eof_index.has_value() && _next_index == _eof_index.value()) {
+        stream_out().end_input();
+    }
+}
+
+//! \details Only the gaps between the slices already stored are filled, so
+//! the stored slices never overlap and bytes pushed twice are counted once.
+void StreamReassembler::store(const Buffer &data, const size_t index) {
+    // Drop whatever falls before `_next_index` or beyond the window.
+    size_t start = max(index, _next_index);
+    const size_t end = min(index + data.size(), _next_index + _capacity);
+
+    if (start >= end) {
+        return;
     }
 
-    // We should calculate consecutive `_dirty[index]` from `_next_index`.
-    // Pay attention, you shouldn't set the `dirty[index]` to false,
-    // because we DO NOT KNOW the ByteStream's size, so we
-    // need to get the bytes actually written into the `_output`.
-    string send_str{};
-    for (size_t i = start_index; _dirty[i]; i = next(i)) {
-        send_str.push_back(_stream[i]);
-        if (next(i) == start_index)
-            break;
+    _recent.push_front(start);
+    if (_recent.size() > MAX_RANGES) {
+        _recent.pop_back();
+    }
+    add_range(start, end);
+
+    // The part of `data` between stream indices `from` and `to`
+    const auto slice_of = [&](const size_t from, const size_t to) {
+        Buffer slice = data;
+        slice.remove_prefix(from - index);
+        slice.remove_suffix(index + data.size() - to);
+        return slice;
+    };
+
+    // Behind a hole, most substrings land after everything already stored;
+    // append those at the end of the map without searching it.
+    if (_pending.empty() || prev(_pending.end())->first + prev(_pending.end())->second.size() <= start) {
+        _pending.emplace_hint(_pending.end(), start, slice_of(start, end));
+        _unassembly += end - start;
+        return;
     }
 
-    // If there is need to send the bytes
-    if (!send_str.empty()) {
-        size_t write_num = stream_out().write(send_str);
-        for (size_t i = start_index, j = 0; j < write_num; i = next(i), ++j) {
-            _dirty[i] = false;
+    // Start from the slice that contains `start`, if there is one.
+    auto it = _pending.upper_bound(start);
+    if (it != _pending.begin() && prev(it)->first + prev(it)->second.size() > start) {
+        --it;
+    }
+
+    while (start < end) {
+        const size_t gap_end = it == _pending.end() ? end : min(it->first, end);
+        if (start < gap_end) {
+            _pending.emplace_hint(it, start, slice_of(start, gap_end));
+            _unassembly += gap_end - start;
+        }
+        if (it == _pending.end()) {
+            break;
         }
+        start = max(start, it->first + it->second.size());
+        ++it;
+    }
+}
+
+void StreamReassembler::flush() {
+    while (!_pending.empty() && _pending.begin()->first == _next_index) {
+        auto first = _pending.begin();
+        const size_t write_num = stream_out().write(first->second);
         _next_index += write_num;
         _unassembly -= write_num;
+
+        if (write_num == first->second.size()) {
+            _pending.erase(first);
+            continue;
+        }
+
+        // When the ByteStream is full, keep the rest for later, keyed by its new first index.
+        if (write_num > 0) {
+            Buffer rest = move(first->second);
+            rest.remove_prefix(write_num);
+            _pending.erase(first);
+            _pending.emplace_hint(_pending.begin(), _next_index, move(rest));
+        }
+        break;
     }
 
-    if (_should_eof && empty()) {
-        stream_out().end_input();
+    // The range that was at the old next index lost its written bytes.
+    if (!_ranges.empty() && _ranges.begin()->first < _next_index) {
+        const size_t last = _ranges.begin()->second;
+        _ranges.erase(_ranges.begin());
+        if (last > _next_index) {
+            _ranges.emplace_hint(_ranges.begin(), _next_index, last);
+        }
+    }
+}
+
+void StreamReassembler::add_range(size_t first, size_t last) {
+    auto it = _ranges.upper_bound(first);
+    if (it != _ranges.begin() && prev(it)->second >= first) {
+        --it;
+        first = it->first;
+    }
+    while (it != _ranges.end() && it->first <= last) {
+        last = max(last, it->second);
+        it = _ranges.erase(it);
+    }
+    _ranges.emplace_hint(it, first, last);
+}
+
+optional<pair<size_t, size_t>> StreamReassembler::range_holding(const size_t index) const {
+    const auto it = _ranges.upper_bound(index);
+    if (it == _ranges.begin() || prev(it)->second <= index) {
+        return nullopt;
+    }
+    return *prev(it);
+}
+
+//! \details [RFC 2018](\ref rfc::rfc2018) asks for the block holding the most
+//! recently received segment first, so that a receiver's latest news reaches
+//! the sender even if it only looks at the first block.
+vector<pair<size_t, size_t>> StreamReassembler::out_of_order_ranges() const {
+    vector<pair<size_t, size_t>> ranges{};
+    const auto add = [&](const pair<size_t, size_t> &range) {
+        // bytes waiting at the next index (for room in the output stream) aren't out of order
+        if (range.first > _next_index && ranges.size() < MAX_RANGES &&
+            find(ranges.begin(), ranges.end(), range) == ranges.end()) {
+            ranges.push_back(range);
+        }
+    };
+
+    for (const size_t index : _recent) {
+        const auto range = range_holding(index);
+        if (range.has_value()) {
+            add(range.value());
+        }
+    }
+    for (auto it = _ranges.begin(); it != _ranges.end() && ranges.size() < MAX_RANGES; ++it) {
+        add(*it);
     }
+    return ranges;
 }
 
 size_t StreamReassembler::unassembled_bytes() const { return {_unassembly}; }
@@ -1,24 +1,55 @@
 #ifndef SPONGE_LIBSPONGE_STREAM_REASSEMBLER_HH
 #define SPONGE_LIBSPONGE_STREAM_REASSEMBLER_HH
 
+#include "buffer.hh"
 #include "byte_stream.hh"
 
 #include <cstdint>
+#include <deque>
+#include <map>
+#include <optional>
 #include <string>
+#include <utility>
 #include <vector>
 
 //! \brief A class that assembles a series of excerpts from a byte stream (possibly out of order,
 //! possibly overlapping) into an in-order byte stream.
+//!
+//! Bytes that can't be written yet are kept as non-overlapping Buffer
+//! slices in a map keyed by stream index, so storing a substring costs
+//! O(log n) in the number of slices and no byte is copied: contiguous
+//! slices are handed to the output ByteStream as they are. A substring
+//! that arrives in order, with nothing stored, skips the map entirely.
 class StreamReassembler {
+  public:
+    //! \brief How the substrings pushed so far were handled
+    struct Stats {
+        uint64_t fast_path = 0;  //!< substrings written straight into the output stream
+        uint64_t slow_path = 0;  //!< substrings that went through the stored slices
+    };
+
   private:
-    ByteStream _output;           //!< The reassembled in-order byte stream
-    size_t _capacity;             //!< The maximum number of bytes
-    size_t _next_index = 0;       //!< The next index we except
-    size_t _unassembly = 0;       //!< The number of bytes in the substrings stored but not yet reassembled
-    bool _should_eof = false;     //!< Flag about telling ByteStream to end input
-    std::vector<char> _stream{};  //!< The window
-    std::vector<bool> _dirty{};   //!< A table to indicate whether the element is stored
-    size_t next(size_t ptr) { return (ptr + 1) % _capacity; }
+    ByteStream _output;                   //!< The reassembled in-order byte stream
+    size_t _capacity;                     //!< The maximum number of bytes
+    size_t _next_index = 0;               //!< The next index we except
+    size_t _unassembly = 0;               //!< The number of bytes in the substrings stored but not yet reassembled
+    std::optional<size_t> _eof_index{};   //!< The index just past the last byte, once known
+    std::map<size_t, Buffer> _pending{};  //!< The stored slices, keyed by the index of their first byte
+    Stats _stats{};                       //!< How the substrings pushed so far were handled
+    std::map<size_t, size_t> _ranges{};   //!< The stored bytes as maximal [first, last) ranges, keyed by first
+    std::deque<size_t> _recent{};         //!< Where the latest out-of-order substrings were stored, newest first
+
+    //! Record that [first, last) is now stored, merging it with the ranges it touches
+    void add_range(size_t first, size_t last);
+
+    //! \returns the [first, last) range of contiguous stored bytes that holds `index`, if any
+    std::optional<std::pair<size_t, size_t>> range_holding(const size_t index) const;
+
+    //! Store the part of `data` (which starts at `index`) that no stored slice covers yet
+    void store(const Buffer &data, const size_t index);
+
+    //! Write the stored slices that start at `_next_index` into the output stream
+    void flush();
 
   public:
     //! \brief Construct a `StreamReassembler` that will store up to `capacity` bytes.
@@ -36,6 +67,10 @@ class StreamReassembler {
     //! \param eof the last byte of `data` will be the last byte in the entire stream
     void push_substring(const std::string &data, const uint64_t index, const bool eof);
 
+    //! \brief Receive a substring without copying it; the slices that are kept share `data`'s storage.
+    //! \copydetails push_substring(const std::string &, const uint64_t, const bool)
+    void push_substring(const Buffer &data, const uint64_t index, const bool eof);
+
     //! \name Access the reassembled byte stream
     //!@{
     const ByteStream &stream_out() const { return _output; }
@@ -48,6 +83,18 @@ class StreamReassembler {
     //! should only be counted once for the purpose of this function.
     size_t unassembled_bytes() const;
 
+    //! The most out-of-order ranges reported by out_of_order_ranges()
+    static constexpr size_t MAX_RANGES = 4;
+
+    //! \brief The ranges of contiguous bytes stored beyond the next index, e.g. for
+    //! [SACK](\ref rfc::rfc2018) blocks
+    //! \returns up to MAX_RANGES [first, last) index ranges, the ones holding the most recently
+    //! stored substrings first, then the rest in stream order
+    std::vector<std::pair<size_t, size_t>> out_of_order_ranges() const;
+
+    //! \returns how often substrings took the in-order fast path, and how often they didn't
+    const Stats &stats() const { return _stats; }
+
     //! \brief Is the internal state empty (other than the output stream)?
     //! \returns `true` if no substrings are waiting to be assembled
     bool empty() const;
@@ -2,9 +2,25 @@
 
 #include <iostream>
 #include <limits>
+#include <random>
 
 using namespace std;
 
+namespace {
+
+//! \returns the smallest window scale that lets a window of `capacity` bytes be advertised
+uint8_t window_shift_for(const size_t capacity) {
+    uint8_t shift = 0;
+    while (shift < TCPHeader::MAX_WINDOW_SCALE && (capacity >> shift) > numeric_limits<uint16_t>::max()) {
+        shift++;
+    }
+    return shift;
+}
+
+}  // namespace
+
+TCPConnection::TCPConnection(const TCPConfig &cfg) : _cfg{cfg}, _timestamp_offset{random_device()()} {}
+
 size_t TCPConnection::remaining_outbound_capacity() const { return _sender.stream_in().remaining_capacity(); }
 
 size_t TCPConnection::bytes_in_flight() const { return _sender.bytes_in_flight(); }
@@ -18,12 +34,53 @@ void TCPConnection::set_ack_and_window(TCPSegment &seg) {
         seg.header().ack = true;
         seg.header().ackno = _receiver.ackno().value();
     }
+    // RFC 7323: the window on a SYN is never scaled
     size_t window_size = _receiver.window_size();
+    if (!seg.header().syn) {
+        window_size >>= _recv_window_shift;
+    }
     if (window_size > numeric_limits<uint16_t>::max()) {
         window_size = numeric_limits<uint16_t>::max();
     }
 
     seg.header().win = window_size;
+    if (seg.header().ack) {
+        // whatever segment carries the ACK, a delayed one is no longer owed
+        _unacked_segments = 0;
+        _ack_delay_timer.reset();
+        _advertised_edge = seg.header().ackno + (seg.header().syn ? window_size : window_size << _recv_window_shift);
+        _receiver.window_advertised(_advertised_edge.value());
+        _receiver.ack_sent(seg.header().ackno);
+    }
+
+    // Send our MSS on our SYN, and offer SACK, window scaling and timestamps unless the peer's SYN came without them.
+    bool stamp = _timestamps;
+    if (seg.header().syn) {
+        seg.header().mss = _cfg.mss;
+        seg.header().sack_permitted = _cfg.sack && (!_receiver.ackno().has_value() || _sack_permitted);
+        if (_cfg.window_scaling && (!_receiver.ackno().has_value() || _window_scaling)) {
+            seg.header().window_scale = window_shift_for(_cfg.recv_capacity);
+        }
+        stamp = _cfg.timestamps && (!_receiver.ackno().has_value() || _timestamps);
+    }
+    if (stamp) {
+        seg.header().timestamp = TCPHeader::Timestamp{timestamp_now(), _receiver.ts_recent().value_or(0)};
+    }
+    if (_sack_permitted) {
+        seg.header().sack = _receiver.sack_blocks();
+        // the options must fit in 40 bytes, so timestamps leave room for three blocks only
+        while (seg.header().required_doff() > TCPHeader::MAX_LENGTH / 4) {
+            seg.header().sack.pop_back();
+        }
+        // and a full-size segment has no room for blocks beyond what the MSS left for its timestamps
+        const size_t piece = seg.gso_size() != 0 ? seg.gso_size() : seg.payload().size();
+        const size_t option_room = _sender.mss() + (_timestamps ? TCPHeader::TIMESTAMP_SPACE : 0);
+        while (!seg.header().sack.empty() && piece > 0 &&
+               4 * seg.header().required_doff() - TCPHeader::LENGTH + piece > option_room) {
+            seg.header().sack.pop_back();
+        }
+    }
+    seg.header().doff = seg.header().required_doff();
 }
 
 bool TCPConnection::send_new_segments() {
@@ -38,6 +95,47 @@ bool TCPConnection::send_new_segments() {
     return is_really_send;
 }
 
+//! \details An ACK is owed at once for out-of-order data, a duplicate or a segment that
+//! fills a hole (so the peer's loss recovery isn't slowed), for a SYN or FIN, for the
+//! second segment since the last ACK, and when the window has opened. Otherwise it
+//! waits up to `ack_delay` ms for the next segment or for data to ride on.
+bool TCPConnection::delay_ack(const TCPSegment &seg, const optional<WrappingInt32> previous_ackno) {
+    if (!_cfg.delayed_ack || seg.header().syn || seg.header().fin || !previous_ackno.has_value()) {
+        return false;
+    }
+    const bool in_order = seg.header().seqno == previous_ackno.value() &&
+                          _receiver.ackno() == previous_ackno.value() + seg.length_in_sequence_space();
+    // a segment merged on receive (see TCPSegmentCoalescer) counts as each of its pieces
+    _unacked_segments += 1 + seg.merged_payload().size();
+    if (!in_order || window_update_due() || _unacked_segments >= 2) {
+        return false;
+    }
+    if (!_ack_delay_timer.has_value()) {
+        _ack_delay_timer = 0;
+    }
+    return true;
+}
+
+//! \details [RFC 1122](\ref rfc::rfc1122), section 4.2.3.3: the window is worth an
+//! update once it has grown by half the buffer or a full segment, whichever is less.
+bool TCPConnection::window_update_due() const {
+    if (!_advertised_edge.has_value() || !_receiver.ackno().has_value()) {
+        return false;
+    }
+    const uint64_t window = min<uint64_t>(_receiver.window_size(),
+                                          uint64_t{numeric_limits<uint16_t>::max()} << _recv_window_shift);
+    const WrappingInt32 edge = _receiver.ackno().value() + window;
+    return edge - _advertised_edge.value() >= static_cast<int64_t>(min<size_t>(_cfg.recv_capacity / 2, _cfg.mss));
+}
+
+void TCPConnection::send_ack_segment() {
+    _sender.send_empty_segment();
+    TCPSegment segment = _sender.segments_out().front();
+    _sender.segments_out().pop();
+    set_ack_and_window(segment);
+    _segments_out.push(segment);
+}
+
 void TCPConnection::send_rst_flag_segment() {
     _sender.send_empty_segment();
     TCPSegment segment = _sender.segments_out().front();
@@ -70,8 +168,28 @@ void TCPConnection::segment_received(const TCPSegment &seg) {
         return;
     }
 
+    if (seg.header().syn) {
+        _sack_permitted = _cfg.sack && seg.header().sack_permitted;
+        _window_scaling = _cfg.window_scaling && seg.header().window_scale.has_value();
+        _timestamps = _cfg.timestamps && seg.header().timestamp.has_value();
+        if (_window_scaling) {
+            _recv_window_shift = window_shift_for(_cfg.recv_capacity);
+            _send_window_shift = min(*seg.header().window_scale, TCPHeader::MAX_WINDOW_SCALE);
+        }
+        _sender.set_mss(seg.header().mss.value_or(0), _timestamps ? TCPHeader::TIMESTAMP_SPACE : 0);
+    }
+
+    // RFC 7323: PAWS drops an old duplicate, whose timestamp is older than one already seen, and ACKs it
+    if (_timestamps && _receiver.paws_rejects(seg)) {
+        if (seg.length_in_sequence_space() > 0) {
+            send_ack_segment();
+        }
+        return;
+    }
+
     // the receiver would update the acknowledge number and window size
     // of itself.
+    const optional<WrappingInt32> previous_ackno = _receiver.ackno();
     _receiver.segment_received(seg);
 
     // If the inbound stream ends before the `TCPConnection` has reached EOF
@@ -80,23 +198,34 @@ void TCPConnection::segment_received(const TCPSegment &seg) {
         _linger_after_streams_finish = false;
     }
 
+    // whether a segment already went out carrying the ACK for this one
+    bool acked = false;
     if (seg.header().ack) {
         // Corner case: When listening, we should drop all the ACK.
         if (!_receiver.ackno().has_value())
             return;
-        _sender.ack_received(seg.header().ackno, seg.header().win);
+        if (_sack_permitted) {
+            _sender.sack_received(seg.header().sack);
+        }
+        if (_timestamps && seg.header().timestamp.has_value()) {
+            // an echo from the future (or garbage) gives no sample
+            const int32_t rtt = static_cast<int32_t>(timestamp_now() - seg.header().timestamp->echo_reply);
+            if (rtt >= 0) {
+                _sender.echoed_rtt_received(rtt);
+            }
+        }
+        // RFC 7323: the window on a SYN is never scaled
+        const uint64_t window = seg.header().syn ? seg.header().win : uint64_t{seg.header().win} << _send_window_shift;
+        _sender.ack_received(seg.header().ackno, window, seg.length_in_sequence_space() == 0);
         _sender.fill_window();
-        send_new_segments();
+        acked = send_new_segments();
     }
 
     if (seg.length_in_sequence_space() > 0) {
         _sender.fill_window();
-        if (!send_new_segments()) {
-            _sender.send_empty_segment();
-            TCPSegment segment = _sender.segments_out().front();
-            _sender.segments_out().pop();
-            set_ack_and_window(segment);
-            _segments_out.push(segment);
+        acked = send_new_segments() || acked;
+        if (!acked && !delay_ack(seg, previous_ackno)) {
+            send_ack_segment();
         }
     }
 }
@@ -110,9 +239,17 @@ size_t TCPConnection::write(const string &data) {
     return length;
 }
 
+size_t TCPConnection::read_from(FileDescriptor &fd, const size_t len) {
+    size_t length = _sender.stream_in().read_from(fd, len);
+    _sender.fill_window();
+    send_new_segments();
+    return length;
+}
+
 //! \param[in] ms_since_last_tick number of milliseconds since the last call to this method
 void TCPConnection::tick(const size_t ms_since_last_tick) {
     _time_since_last_segment_received += ms_since_last_tick;
+    _time += ms_since_last_tick;
     _sender.tick(ms_since_last_tick);
 
     // We need to retransmit the segments
@@ -127,6 +264,19 @@ void TCPConnection::tick(const size_t ms_since_last_tick) {
         _segments_out.push(segment);
     }
 
+    // and send whatever pacing let out
+    if (_active) {
+        send_new_segments();
+    }
+
+    // a delayed ACK that nothing carried goes out on its own once it is due
+    if (_active && _ack_delay_timer.has_value()) {
+        _ack_delay_timer = _ack_delay_timer.value() + ms_since_last_tick;
+        if (_ack_delay_timer.value() >= _cfg.ack_delay || window_update_due()) {
+            send_ack_segment();
+        }
+    }
+
     if (check_inbound_stream_assembled_and_ended() && check_outbound_stream_ended_and_send_fin() &&
         check_outbound_fully_acknowledged()) {
         if (!_linger_after_streams_finish) {
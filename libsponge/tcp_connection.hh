@@ -11,7 +11,7 @@ class TCPConnection {
   private:
     TCPConfig _cfg;
     TCPReceiver _receiver{_cfg.recv_capacity};
-    TCPSender _sender{_cfg.send_capacity, _cfg.rt_timeout, _cfg.fixed_isn};
+    TCPSender _sender{_cfg};
 
     //! outbound queue of segments that the TCPConnection wants sent
     std::queue<TCPSegment> _segments_out{};
@@ -27,8 +27,48 @@ class TCPConnection {
     //! the time interval since last segment received.
     size_t _time_since_last_segment_received{};
 
+    //! whether both SYNs carried the SACK-permitted option
+    bool _sack_permitted{false};
+
+    //! whether both SYNs carried the window scale option
+    bool _window_scaling{false};
+
+    //! the shift of the windows we advertise, once window scaling is agreed
+    uint8_t _recv_window_shift{0};
+
+    //! the shift of the windows the peer advertises, once window scaling is agreed
+    uint8_t _send_window_shift{0};
+
+    //! whether both SYNs carried the timestamps option
+    bool _timestamps{false};
+
+    //! milliseconds since the connection was created, the clock our timestamps are taken from
+    uint64_t _time{0};
+
+    //! the random offset of our timestamp clock, so it doesn't tell how long we have been up
+    uint32_t _timestamp_offset;
+
+    //! our current timestamp value
+    uint32_t timestamp_now() const { return static_cast<uint32_t>(_time) + _timestamp_offset; }
+
+    //! segments received in order since the last ACK we sent, while ACKs are delayed
+    size_t _unacked_segments{0};
+
+    //! milliseconds a delayed ACK has been held back, if one is
+    std::optional<size_t> _ack_delay_timer{};
+
+    //! the right edge (ackno plus window) of the last window we advertised
+    std::optional<WrappingInt32> _advertised_edge{};
+
+    //! \brief whether the ACK for `seg` may be held back ([RFC 1122](\ref rfc::rfc1122) delayed ACKs)
+    //! \param previous_ackno our ackno before `seg` arrived
+    bool delay_ack(const TCPSegment &seg, const std::optional<WrappingInt32> previous_ackno);
+
+    //! whether our window has opened far enough since we last advertised it to tell the peer
+    bool window_update_due() const;
+
     //! \brief the helper function for setting the sending segments'
-    //! acknowledge number and window size
+    //! acknowledge number, window size and options
     void set_ack_and_window(TCPSegment &seg);
 
     //! \brief Pops the segment from the outbound stream and wrap it
@@ -47,6 +87,9 @@ class TCPConnection {
     //! the remote peer
     bool check_outbound_fully_acknowledged();
 
+    //! \brief send an empty segment that just carries the ACK
+    void send_ack_segment();
+
     //! \brief send rst segment
     void send_rst_flag_segment();
 
@@ -64,6 +107,10 @@ class TCPConnection {
     //! \returns the number of bytes from `data` that were actually written.
     size_t write(const std::string &data);
 
+    //! \brief Read (at most) `len` bytes from `fd` into the outbound byte stream, and send them over TCP if possible
+    //! \returns the number of bytes read from `fd`
+    size_t read_from(FileDescriptor &fd, const size_t len);
+
     //! \returns the number of `bytes` that can be written right now.
     size_t remaining_outbound_capacity() const;
 
@@ -100,6 +147,9 @@ class TCPConnection {
     //! Called periodically when time elapses
     void tick(const size_t ms_since_last_tick);
 
+    //! \brief How soon tick() should next be called to send a paced segment on time, if one is held back
+    std::optional<size_t> time_until_paced_send() const { return _sender.time_until_paced_send(); }
+
     //! \brief TCPSegments that the TCPConnection has enqueued for transmission.
     //! \note The owner or operating system will dequeue these and
     //! put each one into the payload of a lower-layer datagram (usually Internet datagrams (IP),
@@ -113,7 +163,7 @@ class TCPConnection {
     //!@}
 
     //! Construct a new connection from a configuration
-    explicit TCPConnection(const TCPConfig &cfg) : _cfg{cfg} {}
+    explicit TCPConnection(const TCPConfig &cfg);
 
     //! \name construction and destruction
     //! moving is allowed; copying is disallowed; default construction not possible
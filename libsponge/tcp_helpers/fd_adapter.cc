@@ -45,12 +45,14 @@ optional<TCPSegment> TCPOverUDPSocketAdapter::read() {
     return seg;
 }
 
-//! Serialize a TCP segment and send it as the payload of a UDP datagram.
+//! Serialize a TCP segment and send it as the payload of a UDP datagram (one per piece, if it is split).
 //! \param[in] seg is the TCP segment to write
 void TCPOverUDPSocketAdapter::write(TCPSegment &seg) {
     seg.header().sport = config().source.port();
     seg.header().dport = config().destination.port();
-    _sock.sendto(config().destination, seg.serialize(0));
+    for (const TCPSegment &piece : seg.split()) {
+        _sock.sendto(config().destination, piece.serialize(0));
+    }
 }
 
 //! Specialize LossyFdAdapter to TCPOverUDPSocketAdapter
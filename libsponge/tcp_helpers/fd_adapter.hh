@@ -8,6 +8,7 @@
 #include "tcp_header.hh"
 #include "tcp_segment.hh"
 
+#include <limits>
 #include <optional>
 #include <utility>
 
@@ -40,6 +41,10 @@ class FdAdapterBase {
 
     //! Called periodically when time elapses
     void tick(const size_t) {}
+
+    //! \brief The largest TCP payload that fits in one datagram of the underlying link
+    //! \returns the largest value an MSS option can carry, for links that don't limit it themselves
+    size_t max_segment_size() const { return std::numeric_limits<uint16_t>::max(); }
 };
 
 //! \brief A FD adaptor that reads and writes TCP segments in UDP payloads
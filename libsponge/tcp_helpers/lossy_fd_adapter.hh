@@ -48,8 +48,14 @@ class LossyFdAdapter {
     }
 
     //! \brief Write to the underlying AdapterT instance, potentially dropping the datagram to be written
-    //! \param[in] seg is the packet to either write or drop
+    //! \param[in] seg is the packet to either write or drop; a segment to be split is dropped piece by piece
     void write(TCPSegment &seg) {
+        if (seg.gso_size() != 0 && seg.payload().size() > seg.gso_size()) {
+            for (TCPSegment &piece : seg.split()) {
+                write(piece);
+            }
+            return;
+        }
         if (_should_drop(true)) {
             return;
         }
@@ -66,6 +72,9 @@ class LossyFdAdapter {
     void tick(const size_t ms_since_last_tick) {
         _adapter.tick(ms_since_last_tick);
     }  //!< FdAdapterBase::tick passthrough
+    size_t max_segment_size() const {
+        return _adapter.max_segment_size();
+    }  //!< FdAdapterBase::max_segment_size passthrough
     //!@}
 };
 
@@ -2,6 +2,7 @@
 #define SPONGE_LIBSPONGE_TCP_CONFIG_HH
 
 #include "address.hh"
+#include "congestion_control.hh"
 #include "wrapping_integers.hh"
 
 #include <cstddef>
@@ -15,11 +16,30 @@ class TCPConfig {
     static constexpr size_t MAX_PAYLOAD_SIZE = 1000;   //!< Conservative max payload size for real Internet
     static constexpr uint16_t TIMEOUT_DFLT = 1000;     //!< Default re-transmit timeout is 1 second
     static constexpr unsigned MAX_RETX_ATTEMPTS = 8;   //!< Maximum re-transmit attempts before giving up
+    static constexpr uint16_t MIN_RTO_DFLT = 200;      //!< Default lower bound of an adaptive re-transmit timeout
+    static constexpr uint16_t MAX_RTO_DFLT = 60000;    //!< Default upper bound of an adaptive re-transmit timeout
+    static constexpr uint16_t ACK_DELAY_DFLT = 40;     //!< Default longest time an ACK is held back
+    static constexpr size_t GSO_MAX_SIZE = 65536;      //!< Largest payload of a segment built for GSO
 
     uint16_t rt_timeout = TIMEOUT_DFLT;       //!< Initial value of the retransmission timeout, in milliseconds
+    bool adaptive_rto = false;                //!< Derive the timeout from measured RTTs ([RFC 6298](\ref rfc::rfc6298))
+    uint16_t min_rto = MIN_RTO_DFLT;          //!< Lower bound of an adaptive timeout, in ms
+    uint16_t max_rto = MAX_RTO_DFLT;          //!< Upper bound of an adaptive timeout and its backoff, in ms
     size_t recv_capacity = DEFAULT_CAPACITY;  //!< Receive capacity, in bytes
     size_t send_capacity = DEFAULT_CAPACITY;  //!< Sender capacity, in bytes
+    uint16_t mss = MAX_PAYLOAD_SIZE;          //!< Largest payload to receive (sent as the MSS option) and to send
     std::optional<WrappingInt32> fixed_isn{};
+    bool sack = false;            //!< Offer [SACK](\ref rfc::rfc2018) on the SYN, and send SACK blocks if agreed
+    bool window_scaling = false;  //!< Offer [window scaling](\ref rfc::rfc7323), so windows can exceed 64 KiB
+    bool timestamps = false;      //!< Offer [timestamps](\ref rfc::rfc7323), for RTT samples and PAWS
+    CongestionControl congestion_control = CongestionControl::none;  //!< Limit the sender to a congestion window
+    bool fast_retransmit = false;  //!< Resend on three duplicate ACKs ([RFC 6582](\ref rfc::rfc6582) recovery)
+    bool pacing = false;           //!< Spread new segments over the round trip instead of sending a window at once
+    size_t pacing_rate = 0;        //!< Pacing rate in bytes per second, or 0 to derive it from the window and RTT
+    bool delayed_ack = false;      //!< ACK every second full-size segment ([RFC 1122](\ref rfc::rfc1122))
+    uint16_t ack_delay = ACK_DELAY_DFLT;  //!< Longest time a delayed ACK is held back, in ms
+    bool gso = false;  //!< Build segments of up to GSO_MAX_SIZE bytes, which the adapter splits into MSS-sized ones
+    bool persist_timer = false;  //!< Probe a closed window on a timer that backs off ([RFC 1122](\ref rfc::rfc1122))
 };
 
 //! Config for classes derived from FdAdapter
@@ -30,6 +50,8 @@ class FdAdapterConfig {
 
     uint16_t loss_rate_dn = 0;  //!< Downlink loss rate (for LossyFdAdapter)
     uint16_t loss_rate_up = 0;  //!< Uplink loss rate (for LossyFdAdapter)
+
+    bool gro = false;  //!< Read every queued datagram at once, merging in-order segments (TCPSegmentCoalescer)
 };
 
 #endif  // SPONGE_LIBSPONGE_TCP_CONFIG_HH
@@ -37,8 +37,78 @@ ParseResult TCPHeader::parse(NetParser &p) {
         return ParseResult::HeaderTooShort;
     }
 
-    // skip any options or anything extra in the header
-    p.remove_prefix(doff * 4 - TCPHeader::LENGTH);
+    // Decode the options we know, and keep the rest as they are. Like most
+    // stacks, stop at the first malformed option instead of rejecting the segment.
+    mss.reset();
+    window_scale.reset();
+    timestamp.reset();
+    sack_permitted = false;
+    sack.clear();
+    other_options.clear();
+    size_t options_left = doff * 4 - TCPHeader::LENGTH;
+    while (options_left > 0 and not p.error()) {
+        const uint8_t kind = p.u8();
+        options_left--;
+        if (kind == TCPOptionKind::EOL) {
+            break;
+        }
+        if (kind == TCPOptionKind::NOP) {
+            continue;
+        }
+        const uint8_t len = options_left > 0 ? p.u8() : 0;
+        options_left = options_left > 0 ? options_left - 1 : 0;
+        if (len < 2 or len - 2u > options_left or p.error()) {
+            break;
+        }
+        const size_t body = len - 2;
+        options_left -= body;
+        switch (kind) {
+            case TCPOptionKind::MSS:
+                if (body == 2) {
+                    mss = p.u16();
+                    continue;
+                }
+                break;
+            case TCPOptionKind::WINDOW_SCALE:
+                if (body == 1) {
+                    window_scale = p.u8();
+                    continue;
+                }
+                break;
+            case TCPOptionKind::TIMESTAMPS:
+                if (body == 8) {
+                    const uint32_t value = p.u32();
+                    timestamp = Timestamp{value, p.u32()};
+                    continue;
+                }
+                break;
+            case TCPOptionKind::SACK_PERMITTED:
+                if (body == 0) {
+                    sack_permitted = true;
+                    continue;
+                }
+                break;
+            case TCPOptionKind::SACK:
+                if (body % 8 == 0 and body / 8 <= MAX_SACK_BLOCKS) {
+                    for (size_t i = 0; i < body / 8; i++) {
+                        const WrappingInt32 left{p.u32()};
+                        sack.push_back({left, WrappingInt32{p.u32()}});
+                    }
+                    continue;
+                }
+                break;
+            default:
+                break;
+        }
+        // an option we don't know (or a known one of the wrong length): keep its bytes
+        if (p.buffer().size() >= body) {
+            other_options.add(kind, p.buffer().str().substr(0, body));
+        }
+        p.remove_prefix(body);
+    }
+
+    // skip any padding or anything extra in the header
+    p.remove_prefix(options_left);
 
     if (p.error()) {
         return p.get_error();
@@ -53,6 +123,9 @@ string TCPHeader::serialize() const {
     if (doff < 5) {
         throw runtime_error("TCP header too short");
     }
+    if (doff < required_doff()) {
+        throw runtime_error("TCP header too short for its options");
+    }
 
     string ret;
     ret.reserve(4 * doff);
@@ -72,11 +145,70 @@ string TCPHeader::serialize() const {
 
     NetUnparser::u16(ret, uptr);  // urgent pointer
 
-    ret.resize(4 * doff);  // expand header to advertised size
+    // each option is padded with leading NOPs to a multiple of 4 bytes
+    if (mss.has_value()) {
+        NetUnparser::u8(ret, TCPOptionKind::MSS);
+        NetUnparser::u8(ret, 4);
+        NetUnparser::u16(ret, *mss);
+    }
+    if (window_scale.has_value()) {
+        NetUnparser::u8(ret, TCPOptionKind::NOP);
+        NetUnparser::u8(ret, TCPOptionKind::WINDOW_SCALE);
+        NetUnparser::u8(ret, 3);
+        NetUnparser::u8(ret, *window_scale);
+    }
+    if (timestamp.has_value()) {
+        NetUnparser::u8(ret, TCPOptionKind::NOP);
+        NetUnparser::u8(ret, TCPOptionKind::NOP);
+        NetUnparser::u8(ret, TCPOptionKind::TIMESTAMPS);
+        NetUnparser::u8(ret, 10);
+        NetUnparser::u32(ret, timestamp->value);
+        NetUnparser::u32(ret, timestamp->echo_reply);
+    }
+    if (sack_permitted) {
+        NetUnparser::u8(ret, TCPOptionKind::NOP);
+        NetUnparser::u8(ret, TCPOptionKind::NOP);
+        NetUnparser::u8(ret, TCPOptionKind::SACK_PERMITTED);
+        NetUnparser::u8(ret, 2);
+    }
+    if (not sack.empty()) {
+        NetUnparser::u8(ret, TCPOptionKind::NOP);
+        NetUnparser::u8(ret, TCPOptionKind::NOP);
+        NetUnparser::u8(ret, TCPOptionKind::SACK);
+        NetUnparser::u8(ret, 2 + 8 * sack.size());
+        for (const auto &block : sack) {
+            NetUnparser::u32(ret, block.left.raw_value());
+            NetUnparser::u32(ret, block.right.raw_value());
+        }
+    }
+    ret.append(other_options.bytes());  // the options we don't know, as they came
+
+    ret.resize(4 * doff);  // expand header to advertised size (the zeros are EOL options)
 
     return ret;
 }
 
+uint8_t TCPHeader::required_doff() const {
+    size_t words = LENGTH / 4;
+    if (mss.has_value()) {
+        words += 1;
+    }
+    if (window_scale.has_value()) {
+        words += 1;
+    }
+    if (timestamp.has_value()) {
+        words += 3;
+    }
+    if (sack_permitted) {
+        words += 1;
+    }
+    if (not sack.empty()) {
+        words += 1 + 2 * sack.size();
+    }
+    words += (other_options.size() + 3) / 4;
+    return words;
+}
+
 //! \returns A string with the header's contents
 string TCPHeader::to_string() const {
     stringstream ss{};
@@ -89,14 +221,42 @@ string TCPHeader::to_string() const {
        << " fin: " << fin << '\n'
        << "TCP winsize: " << +win << '\n'
        << "TCP cksum: " << +cksum << '\n'
-       << "TCP uptr: " << +uptr << '\n';
+       << "TCP uptr: " << +uptr << '\n'
+       << "TCP mss: " << (mss.has_value() ? std::to_string(*mss) : "none") << '\n'
+       << "TCP window scale: " << (window_scale.has_value() ? std::to_string(*window_scale) : "none") << '\n'
+       << "TCP sack permitted: " << sack_permitted << '\n';
+    if (timestamp.has_value()) {
+        ss << "TCP timestamps: " << timestamp->value << '/' << timestamp->echo_reply << '\n';
+    }
+    for (const auto &block : sack) {
+        ss << "TCP sack block: " << block.left << '-' << block.right << '\n';
+    }
+    if (not other_options.empty()) {
+        ss << "TCP other options: " << other_options.size() << " bytes\n";
+    }
     return ss.str();
 }
 
 string TCPHeader::summary() const {
     stringstream ss{};
     ss << "Header(flags=" << (syn ? "S" : "") << (ack ? "A" : "") << (rst ? "R" : "") << (fin ? "F" : "")
-       << ",seqno=" << seqno << ",ack=" << ackno << ",win=" << win << ")";
+       << ",seqno=" << seqno << ",ack=" << ackno << ",win=" << win;
+    if (mss.has_value()) {
+        ss << ",mss=" << *mss;
+    }
+    if (window_scale.has_value()) {
+        ss << ",wscale=" << +*window_scale;
+    }
+    if (timestamp.has_value()) {
+        ss << ",ts=" << timestamp->value << '/' << timestamp->echo_reply;
+    }
+    if (sack_permitted) {
+        ss << ",sackok";
+    }
+    for (const auto &block : sack) {
+        ss << ",sack=" << block.left << '-' << block.right;
+    }
+    ss << ")";
     return ss.str();
 }
 
@@ -104,5 +264,7 @@ bool TCPHeader::operator==(const TCPHeader &other) const {
     // TODO(aozdemir) more complete check (right now we omit cksum, src, dst
     return seqno == other.seqno && ackno == other.ackno && doff == other.doff && urg == other.urg && ack == other.ack &&
            psh == other.psh && rst == other.rst && syn == other.syn && fin == other.fin && win == other.win &&
-           uptr == other.uptr;
+           uptr == other.uptr && mss == other.mss && window_scale == other.window_scale &&
+           timestamp == other.timestamp && sack_permitted == other.sack_permitted && sack == other.sack &&
+           other_options == other.other_options;
 }
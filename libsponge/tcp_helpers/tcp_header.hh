@@ -2,12 +2,41 @@
 #define SPONGE_LIBSPONGE_TCP_HEADER_HH
 
 #include "parser.hh"
+#include "tcp_options.hh"
 #include "wrapping_integers.hh"
 
+#include <optional>
+
 //! \brief [TCP](\ref rfc::rfc793) segment header
-//! \note TCP options are not supported
+//! \note Of the TCP options, MSS, [window scale and timestamps](\ref rfc::rfc7323) and
+//! [SACK](\ref rfc::rfc2018) are decoded into fields; others are kept in `other_options`
 struct TCPHeader {
-    static constexpr size_t LENGTH = 20;  //!< [TCP](\ref rfc::rfc793) header length, not including options
+    static constexpr size_t LENGTH = 20;             //!< [TCP](\ref rfc::rfc793) header length, not including options
+    static constexpr size_t MAX_LENGTH = 60;         //!< the longest header, with 40 bytes of options
+    static constexpr size_t MAX_SACK_BLOCKS = 4;     //!< the most SACK blocks that fit in the options
+    static constexpr size_t TIMESTAMP_SPACE = 12;    //!< the option bytes a timestamp takes, with its padding
+    static constexpr uint8_t MAX_WINDOW_SCALE = 14;  //!< the largest window scale [RFC 7323](\ref rfc::rfc7323) allows
+
+    //! \brief A [SACK](\ref rfc::rfc2018) block: the receiver holds the bytes from `left` up to (not including) `right`
+    struct SACKBlock {
+        WrappingInt32 left{0};   //!< the first sequence number of the block
+        WrappingInt32 right{0};  //!< the sequence number just past the block
+
+        bool operator==(const SACKBlock &other) const { return left == other.left && right == other.right; }
+    };
+
+    //! \brief The SACK blocks of one header, stored inline
+    using SACKBlocks = InlineVector<SACKBlock, MAX_SACK_BLOCKS>;
+
+    //! \brief A [timestamps](\ref rfc::rfc7323) option: the sender's clock, and the latest value it received
+    struct Timestamp {
+        uint32_t value;       //!< TSval, the sender's clock when it sent the segment
+        uint32_t echo_reply;  //!< TSecr, the TSval the sender echoes back (valid when the ACK flag is set)
+
+        bool operator==(const Timestamp &other) const {
+            return value == other.value && echo_reply == other.echo_reply;
+        }
+    };
 
     //! \struct TCPHeader
     //! ~~~{.txt}
@@ -50,6 +79,19 @@ struct TCPHeader {
     uint16_t uptr = 0;          //!< urgent pointer
     //!@}
 
+    //! \name TCP options
+    //!@{
+    std::optional<uint16_t> mss{};          //!< MSS option (on a SYN): the largest payload the sender accepts
+    std::optional<uint8_t> window_scale{};  //!< window scale option (on a SYN): the shift of the sender's later windows
+    std::optional<Timestamp> timestamp{};   //!< timestamps option (on every segment, once both SYNs carried it)
+    bool sack_permitted = false;            //!< SACK-permitted option (on a SYN)
+    SACKBlocks sack{};                      //!< SACK option blocks
+    TCPRawOptions other_options{};          //!< options of other kinds, serialized after the ones above
+    //!@}
+
+    //! \returns the smallest `doff` that leaves room for the options that are set
+    uint8_t required_doff() const;
+
     //! Parse the TCP fields from the provided NetParser
     ParseResult parse(NetParser &p);
 
@@ -0,0 +1,31 @@
+#include "tcp_options.hh"
+
+using namespace std;
+
+//! \param[in] kind the option kind, which must not be EOL or NOP (those have no length byte)
+//! \param[in] body the option's value, without the kind and length bytes
+bool TCPRawOptions::add(const uint8_t kind, const string_view body) {
+    if (kind == TCPOptionKind::EOL or kind == TCPOptionKind::NOP) {
+        throw invalid_argument("EOL and NOP are padding, not options");
+    }
+    if (_length + 2 + body.size() > MAX_LENGTH) {
+        return false;
+    }
+    _bytes[_length++] = static_cast<char>(kind);
+    _bytes[_length++] = static_cast<char>(2 + body.size());
+    body.copy(_bytes.data() + _length, body.size());
+    _length += body.size();
+    return true;
+}
+
+//! \details The options are walked by their length bytes, which add() always wrote.
+optional<string_view> TCPRawOptions::find(const uint8_t kind) const {
+    for (size_t i = 0; i + 2 <= _length;) {
+        const auto length = static_cast<uint8_t>(_bytes[i + 1]);
+        if (static_cast<uint8_t>(_bytes[i]) == kind) {
+            return bytes().substr(i + 2, length - 2);
+        }
+        i += length;
+    }
+    return {};
+}
@@ -0,0 +1,116 @@
+#ifndef SPONGE_LIBSPONGE_TCP_OPTIONS_HH
+#define SPONGE_LIBSPONGE_TCP_OPTIONS_HH
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <optional>
+#include <stdexcept>
+#include <string_view>
+
+//! \brief [TCP option](\ref rfc::rfc793) kinds
+//! \details Options of other kinds are kept as raw bytes (see TCPRawOptions).
+struct TCPOptionKind {
+    static constexpr uint8_t EOL = 0;             //!< end of option list
+    static constexpr uint8_t NOP = 1;             //!< no-operation (padding)
+    static constexpr uint8_t MSS = 2;             //!< maximum segment size
+    static constexpr uint8_t WINDOW_SCALE = 3;    //!< [window scale](\ref rfc::rfc7323)
+    static constexpr uint8_t SACK_PERMITTED = 4;  //!< [SACK](\ref rfc::rfc2018) permitted
+    static constexpr uint8_t SACK = 5;            //!< [SACK](\ref rfc::rfc2018) blocks
+    static constexpr uint8_t TIMESTAMPS = 8;      //!< [timestamps](\ref rfc::rfc7323)
+};
+
+//! \brief A vector of at most `N` elements, stored inline so that copying a header never allocates
+template <typename T, size_t N>
+class InlineVector {
+  private:
+    std::array<T, N> _elements{};
+    size_t _size{0};
+
+  public:
+    InlineVector() = default;
+
+    //! \throws std::length_error if there are more than `N` elements
+    InlineVector(std::initializer_list<T> elements) {
+        for (const auto &element : elements) {
+            push_back(element);
+        }
+    }
+
+    static constexpr size_t capacity() { return N; }
+    size_t size() const { return _size; }
+    bool empty() const { return _size == 0; }
+    bool full() const { return _size == N; }
+
+    //! \throws std::length_error if the vector is full
+    void push_back(const T &element) {
+        if (full()) {
+            throw std::length_error("InlineVector is full");
+        }
+        _elements[_size++] = element;
+    }
+
+    void pop_back() { _size--; }
+    void clear() { _size = 0; }
+
+    T &operator[](const size_t n) { return _elements[n]; }
+    const T &operator[](const size_t n) const { return _elements[n]; }
+
+    //! \throws std::out_of_range if `n` is past the end
+    const T &at(const size_t n) const {
+        if (n >= _size) {
+            throw std::out_of_range("InlineVector::at");
+        }
+        return _elements[n];
+    }
+
+    T *begin() { return _elements.data(); }
+    T *end() { return _elements.data() + _size; }
+    const T *begin() const { return _elements.data(); }
+    const T *end() const { return _elements.data() + _size; }
+
+    bool operator==(const InlineVector &other) const {
+        if (_size != other._size) {
+            return false;
+        }
+        for (size_t i = 0; i < _size; i++) {
+            if (not(_elements[i] == other._elements[i])) {
+                return false;
+            }
+        }
+        return true;
+    }
+    bool operator!=(const InlineVector &other) const { return not(*this == other); }
+};
+
+//! \brief The TCP options a TCPHeader has no field for, kept as their kind, length and value bytes
+//! \details They are stored back to back in a fixed array as long as all the room a header
+//! has for options, so an option this stack doesn't know survives a parse and serialize.
+class TCPRawOptions {
+  public:
+    static constexpr size_t MAX_LENGTH = 40;  //!< the most bytes of options a header holds
+
+  private:
+    std::array<char, MAX_LENGTH> _bytes{};
+    size_t _length{0};
+
+  public:
+    //! \brief Append an option
+    //! \returns `false` (and leaves the options unchanged) if it doesn't fit
+    bool add(const uint8_t kind, const std::string_view body);
+
+    //! \returns the value of the first option of this kind, if there is one
+    std::optional<std::string_view> find(const uint8_t kind) const;
+
+    //! the options, ready to be copied into a header
+    std::string_view bytes() const { return {_bytes.data(), _length}; }
+
+    size_t size() const { return _length; }
+    bool empty() const { return _length == 0; }
+    void clear() { _length = 0; }
+
+    bool operator==(const TCPRawOptions &other) const { return bytes() == other.bytes(); }
+};
+
+#endif  // SPONGE_LIBSPONGE_TCP_OPTIONS_HH
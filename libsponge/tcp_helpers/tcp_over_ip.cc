@@ -70,21 +70,23 @@ optional<TCPSegment> TCPOverIPv4Adapter::unwrap_tcp_in_ip(const InternetDatagram
     return tcp_seg;
 }
 
-//! Takes a TCP segment, sets port numbers as necessary, and wraps it in an IPv4 datagram
-//! \param[in] seg is the TCP segment to convert
-InternetDatagram TCPOverIPv4Adapter::wrap_tcp_in_ip(TCPSegment &seg) {
-    // set the port numbers in the TCP segment
+//! Takes a TCP segment, sets port numbers as necessary, and wraps each of its wire segments in an IPv4 datagram
+//! \param[in] seg is the TCP segment to convert, which may be larger than the link allows
+//! \details The ports and the IPv4 header are set up once and copied for every
+//! piece; each piece only gets its own length and checksum.
+vector<InternetDatagram> TCPOverIPv4Adapter::wrap_tcp_in_ips(TCPSegment &seg) {
     seg.header().sport = config().source.port();
     seg.header().dport = config().destination.port();
 
-    // create an Internet Datagram and set its addresses and length
-    InternetDatagram ip_dgram;
-    ip_dgram.header().src = config().source.ipv4_numeric();
-    ip_dgram.header().dst = config().destination.ipv4_numeric();
-    ip_dgram.header().len = ip_dgram.header().hlen * 4 + seg.header().doff * 4 + seg.payload().size();
+    InternetDatagram ip_template;
+    ip_template.header().src = config().source.ipv4_numeric();
+    ip_template.header().dst = config().destination.ipv4_numeric();
 
-    // set payload, calculating TCP checksum using information from IP header
-    ip_dgram.payload() = seg.serialize(ip_dgram.header().pseudo_cksum());
-
-    return ip_dgram;
+    vector<InternetDatagram> ip_dgrams{};
+    for (const TCPSegment &piece : seg.split()) {
+        InternetDatagram &ip_dgram = ip_dgrams.emplace_back(ip_template);
+        ip_dgram.header().len = ip_dgram.header().hlen * 4 + piece.header().doff * 4 + piece.payload().size();
+        ip_dgram.payload() = piece.serialize(ip_dgram.header().pseudo_cksum());
+    }
+    return ip_dgrams;
 }
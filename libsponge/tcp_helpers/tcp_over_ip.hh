@@ -7,13 +7,15 @@
 #include "tcp_segment.hh"
 
 #include <optional>
+#include <vector>
 
 //! \brief A converter from TCP segments to serialized IPv4 datagrams
 class TCPOverIPv4Adapter : public FdAdapterBase {
   public:
     std::optional<TCPSegment> unwrap_tcp_in_ip(const InternetDatagram &ip_dgram);
 
-    InternetDatagram wrap_tcp_in_ip(TCPSegment &seg);
+    //! \brief Split a segment into its wire segments (see TCPSegment::gso_size) and wrap each in an IPv4 datagram
+    std::vector<InternetDatagram> wrap_tcp_in_ips(TCPSegment &seg);
 };
 
 #endif  // SPONGE_LIBSPONGE_TCP_OVER_IP_HH
@@ -3,10 +3,14 @@
 #include "parser.hh"
 #include "util.hh"
 
+#include <algorithm>
 #include <variant>
 
 using namespace std;
 
+//! where the checksum sits in a serialized TCP header
+static constexpr size_t CHECKSUM_OFFSET = 16;
+
 //! \param[in] buffer string/Buffer to be parsed
 //! \param[in] datagram_layer_checksum pseudo-checksum from the lower-layer protocol
 ParseResult TCPSegment::parse(const Buffer buffer, const uint32_t datagram_layer_checksum) {
@@ -22,23 +26,67 @@ ParseResult TCPSegment::parse(const Buffer buffer, const uint32_t datagram_layer
     return p.get_error();
 }
 
+size_t TCPSegment::payload_size() const {
+    size_t size = _payload.size();
+    for (const Buffer &piece : _merged_payload) {
+        size += piece.size();
+    }
+    return size;
+}
+
 size_t TCPSegment::length_in_sequence_space() const {
-    return payload().str().size() + (header().syn ? 1 : 0) + (header().fin ? 1 : 0);
+    return payload_size() + (header().syn ? 1 : 0) + (header().fin ? 1 : 0);
+}
+
+//! \details The pieces share the header (with its options) and slices of the payload,
+//! so nothing is copied. Each takes the next seqno; the SYN stays on the first,
+//! and the FIN and PSH go on the last.
+vector<TCPSegment> TCPSegment::split() const {
+    if (_gso_size == 0 or _payload.size() <= _gso_size) {
+        TCPSegment whole = *this;
+        whole._gso_size = 0;
+        return {whole};
+    }
+
+    vector<TCPSegment> pieces{};
+    pieces.reserve((_payload.size() + _gso_size - 1) / _gso_size);
+    TCPSegment piece{};
+    piece._header = _header;
+    piece._header.fin = false;
+    piece._header.psh = false;
+    for (size_t offset = 0; offset < _payload.size(); offset += _gso_size) {
+        const size_t length = min(_gso_size, _payload.size() - offset);
+        piece._payload = _payload;
+        piece._payload.remove_prefix(offset);
+        piece._payload.remove_suffix(piece._payload.size() - length);
+        if (offset + length == _payload.size()) {
+            piece._header.fin = _header.fin;
+            piece._header.psh = _header.psh;
+        }
+        pieces.push_back(piece);
+        piece._header.seqno = piece._header.seqno + (piece._header.syn ? 1 : 0) + length;
+        piece._header.syn = false;
+    }
+    return pieces;
 }
 
 //! \param[in] datagram_layer_checksum pseudo-checksum from the lower-layer protocol
+//! \details The header is serialized once, and the checksum is written into it.
 BufferList TCPSegment::serialize(const uint32_t datagram_layer_checksum) const {
     TCPHeader header_out = _header;
     header_out.cksum = 0;
+    string header_bytes = header_out.serialize();
 
     // calculate checksum -- taken over entire segment
     InternetChecksum check(datagram_layer_checksum);
-    check.add(header_out.serialize());
+    check.add(header_bytes);
     check.add(_payload);
-    header_out.cksum = check.value();
+    const uint16_t cksum = check.value();
+    header_bytes[CHECKSUM_OFFSET] = static_cast<char>(cksum >> 8);
+    header_bytes[CHECKSUM_OFFSET + 1] = static_cast<char>(cksum & 0xff);
 
     BufferList ret;
-    ret.append(header_out.serialize());
+    ret.append(Buffer{move(header_bytes)});
     ret.append(_payload);
 
     return ret;
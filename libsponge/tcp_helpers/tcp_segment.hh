@@ -4,13 +4,17 @@
 #include "buffer.hh"
 #include "tcp_header.hh"
 
+#include <cstddef>
 #include <cstdint>
+#include <vector>
 
 //! \brief [TCP](\ref rfc::rfc793) segment
 class TCPSegment {
   private:
     TCPHeader _header{};
     Buffer _payload{};
+    std::vector<Buffer> _merged_payload{};
+    size_t _gso_size{0};
 
   public:
     //! \brief Parse the segment from a string
@@ -26,8 +30,27 @@ class TCPSegment {
 
     const Buffer &payload() const { return _payload; }
     Buffer &payload() { return _payload; }
+
+    //! \brief The pieces after payload() of a segment merged on receive (see TCPSegmentCoalescer)
+    //! \details Each piece keeps the storage it was read into. It is empty, and allocates nothing,
+    //! for every other segment; parse(), serialize() and split() don't use it.
+    const std::vector<Buffer> &merged_payload() const { return _merged_payload; }
+    std::vector<Buffer> &merged_payload() { return _merged_payload; }
+
+    //! \brief The payload length, merged pieces included
+    size_t payload_size() const;
+
+    //! \brief The largest payload of the wire segments this one is split into, or 0 to send it as it is
+    //! \details A sender using generic segmentation offload builds one large segment, and the
+    //! adapter that writes it splits it with split().
+    size_t gso_size() const { return _gso_size; }
+    size_t &gso_size() { return _gso_size; }
     //!@}
 
+    //! \brief The wire segments this one is sent as, each with at most gso_size() bytes of payload
+    //! \note A segment without a gso_size(), or that already fits, is returned whole.
+    std::vector<TCPSegment> split() const;
+
     //! \brief Segment's length in sequence space
     //! \note Equal to payload length plus one byte if SYN is set, plus one byte if FIN is set
     size_t length_in_sequence_space() const;
@@ -0,0 +1,58 @@
+#include "tcp_segment_coalescer.hh"
+
+#include "tcp_config.hh"
+
+#include <utility>
+
+using namespace std;
+
+//! \details This follows the rules of Linux's GRO: a piece with SYN, RST or URG is never
+//! merged, nothing follows a piece with FIN or PSH, and a short piece ends the run.
+//! The headers must match in everything but the seqno, FIN and PSH, options included,
+//! and the ports must too, as TCPHeader's operator== leaves them out.
+bool TCPSegmentCoalescer::extends_tail(const TCPSegment &seg) const {
+    if (_segments.empty()) {
+        return false;
+    }
+    const TCPSegment &tail = _segments.back();
+    const TCPHeader &prev = tail.header();
+    const TCPHeader &next = seg.header();
+    if (prev.syn || prev.fin || prev.rst || prev.urg || prev.psh || next.syn || next.rst || next.urg) {
+        return false;
+    }
+    // only pieces of one flow merge
+    if (prev.sport != next.sport || prev.dport != next.dport) {
+        return false;
+    }
+
+    const size_t merged = tail.payload_size();
+    const size_t piece = tail.gso_size() != 0 ? tail.gso_size() : merged;
+    const size_t length = seg.payload().size();
+    if (piece == 0 || length == 0 || length > piece || merged % piece != 0 ||
+        merged + length > TCPConfig::GSO_MAX_SIZE || next.seqno != prev.seqno + merged) {
+        return false;
+    }
+
+    TCPHeader expected = prev;
+    expected.seqno = next.seqno;
+    expected.fin = next.fin;
+    expected.psh = next.psh;
+    return expected == next;
+}
+
+//! \param[in] seg the segment, which the coalescer keeps or merges into the one before it
+void TCPSegmentCoalescer::push(TCPSegment &&seg) {
+    if (extends_tail(seg)) {
+        TCPSegment &tail = _segments.back();
+        if (tail.gso_size() == 0) {
+            tail.gso_size() = tail.payload().size();
+        }
+        tail.header().fin = seg.header().fin;
+        tail.header().psh = seg.header().psh;
+        tail.merged_payload().push_back(seg.payload());
+        return;
+    }
+    _segments.push_back(move(seg));
+}
+
+vector<TCPSegment> TCPSegmentCoalescer::take() { return exchange(_segments, {}); }
@@ -0,0 +1,31 @@
+#ifndef SPONGE_LIBSPONGE_TCP_SEGMENT_COALESCER_HH
+#define SPONGE_LIBSPONGE_TCP_SEGMENT_COALESCER_HH
+
+#include "tcp_segment.hh"
+
+#include <vector>
+
+//! \brief Merges runs of in-order segments read in one batch into larger ones (generic receive offload)
+//! \details A segment is appended to the one before it when it continues it in sequence space
+//! with the same header, and every piece before it was as large as the first. The merged
+//! segment takes the FIN and PSH of its last piece, and its gso_size() is the size of its
+//! first piece. The first piece stays its payload() and the others go to merged_payload(),
+//! so merging copies nothing.
+class TCPSegmentCoalescer {
+  private:
+    std::vector<TCPSegment> _segments{};  //!< the segments so far; the last one may still grow
+
+    //! \returns whether `seg` can be appended to the last segment
+    bool extends_tail(const TCPSegment &seg) const;
+
+  public:
+    //! \brief Add the next segment read from the link
+    void push(TCPSegment &&seg);
+
+    //! \brief The merged segments, in the order they were read; the coalescer is empty afterwards
+    std::vector<TCPSegment> take();
+
+    bool empty() const { return _segments.empty(); }
+};
+
+#endif  // SPONGE_LIBSPONGE_TCP_SEGMENT_COALESCER_HH
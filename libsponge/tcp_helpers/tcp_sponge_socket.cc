@@ -2,9 +2,11 @@
 
 #include "network_interface.hh"
 #include "parser.hh"
+#include "tcp_segment_coalescer.hh"
 #include "tun.hh"
 #include "util.hh"
 
+#include <algorithm>
 #include <cstddef>
 #include <exception>
 #include <iostream>
@@ -19,13 +21,16 @@
 using namespace std;
 
 static constexpr size_t TCP_TICK_MS = 10;
+static constexpr size_t GRO_MAX_BATCH = 64;  //!< the most datagrams read in one wakeup
 
 //! \param[in] condition is a function returning true if loop should continue
 template <typename AdaptT>
 void TCPSpongeSocket<AdaptT>::_tcp_loop(const function<bool()> &condition) {
     auto base_time = timestamp_ms();
     while (condition()) {
-        auto ret = _eventloop.wait_next_event(TCP_TICK_MS);
+        // wake up early when pacing holds a segment back
+        const size_t timeout = min(TCP_TICK_MS, _tcp.value().time_until_paced_send().value_or(TCP_TICK_MS));
+        auto ret = _eventloop.wait_next_event(timeout);
         if (ret == EventLoop::Result::Exit or _abort) {
             break;
         }
@@ -52,7 +57,16 @@ TCPSpongeSocket<AdaptT>::TCPSpongeSocket(pair<FileDescriptor, FileDescriptor> da
 
 template <typename AdaptT>
 void TCPSpongeSocket<AdaptT>::_initialize_TCP(const TCPConfig &config) {
-    _tcp.emplace(config);
+    // never advertise or send segments larger than the link can carry
+    TCPConfig link_config = config;
+    link_config.mss = min<size_t>(config.mss, _datagram_adapter.max_segment_size());
+    _tcp.emplace(link_config);
+
+    // with GRO, rule 1 reads the link until it would block (the copy shares the link's fd)
+    if (_datagram_adapter.config().gro) {
+        const FileDescriptor &link = _datagram_adapter;
+        link.duplicate().set_blocking(false);
+    }
 
     // Set up the event loop
 
@@ -76,9 +90,28 @@ void TCPSpongeSocket<AdaptT>::_initialize_TCP(const TCPConfig &config) {
     _eventloop.add_rule(_datagram_adapter,
                         Direction::In,
                         [&] {
-                            auto seg = _datagram_adapter.read();
-                            if (seg) {
-                                _tcp->segment_received(move(seg.value()));
+                            if (_datagram_adapter.config().gro) {
+                                // drain what the link has queued and hand over in-order runs as one segment;
+                                // the link is non-blocking, so a read that finds nothing isn't counted
+                                const FileDescriptor &link = _datagram_adapter;
+                                TCPSegmentCoalescer batch{};
+                                for (size_t i = 0; i < GRO_MAX_BATCH; i++) {
+                                    const unsigned int reads = link.read_count();
+                                    auto seg = _datagram_adapter.read();
+                                    if (seg) {
+                                        batch.push(move(seg.value()));
+                                    } else if (link.read_count() == reads) {
+                                        break;
+                                    }
+                                }
+                                for (TCPSegment &seg : batch.take()) {
+                                    _tcp->segment_received(move(seg));
+                                }
+                            } else {
+                                auto seg = _datagram_adapter.read();
+                                if (seg) {
+                                    _tcp->segment_received(move(seg.value()));
+                                }
                             }
 
                             // debugging output:
@@ -96,12 +129,8 @@ void TCPSpongeSocket<AdaptT>::_initialize_TCP(const TCPConfig &config) {
         _thread_data,
         Direction::In,
         [&] {
-            const auto data = _thread_data.read(_tcp->remaining_outbound_capacity());
-            const auto len = data.size();
-            const auto amount_written = _tcp->write(move(data));
-            if (amount_written != len) {
-                throw runtime_error("TCPConnection::write() accepted less than advertised length");
-            }
+            // The bytes are read straight into the outbound stream's free space.
+            _tcp->read_from(_thread_data, _tcp->remaining_outbound_capacity());
 
             if (_thread_data.eof()) {
                 _tcp->end_input_stream();
@@ -128,10 +157,8 @@ void TCPSpongeSocket<AdaptT>::_initialize_TCP(const TCPConfig &config) {
             // Write from the inbound_stream into
             // the pipe, handling the possibility of a partial
             // write (i.e., only pop what was actually written).
-            const size_t amount_to_write = min(size_t(65536), inbound.buffer_size());
-            const std::string buffer = inbound.peek_output(amount_to_write);
-            const auto bytes_written = _thread_data.write(move(buffer), false);
-            inbound.pop_output(bytes_written);
+            // The stored bytes are handed straight to writev(), so nothing is copied.
+            inbound.write_to(_thread_data, 65536);
 
             if (inbound.eof() or inbound.error()) {
                 _thread_data.shutdown(SHUT_WR);
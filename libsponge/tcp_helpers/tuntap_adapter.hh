@@ -27,8 +27,15 @@ class TCPOverIPv4OverTunFdAdapter : public TCPOverIPv4Adapter {
         return unwrap_tcp_in_ip(ip_dgram);
     }
 
-    //! Creates an IPv4 datagram from a TCP segment and writes it to the TUN device
-    void write(TCPSegment &seg) { _tun.write(wrap_tcp_in_ip(seg).serialize()); }
+    //! Creates IPv4 datagrams from a TCP segment (split as its gso_size asks) and writes them to the TUN device
+    void write(TCPSegment &seg) {
+        for (const InternetDatagram &ip_dgram : wrap_tcp_in_ips(seg)) {
+            _tun.write(ip_dgram.serialize());
+        }
+    }
+
+    //! The largest TCP payload that fits in the TUN device's MTU
+    size_t max_segment_size() const { return _tun.mtu() - IPv4Header::LENGTH - TCPHeader::LENGTH; }
 
     //! Access the underlying TUN device
     operator TunFD &() { return _tun; }
@@ -66,6 +73,9 @@ class TCPOverIPv4OverEthernetAdapter : public TCPOverIPv4Adapter {
     //! Called periodically when time elapses
     void tick(const size_t ms_since_last_tick);
 
+    //! The largest TCP payload that fits in the TAP device's MTU (which may allow jumbo frames)
+    size_t max_segment_size() const { return _tap.mtu() - IPv4Header::LENGTH - TCPHeader::LENGTH; }
+
     //! Access the underlying raw Ethernet connection
     operator TapFD &() { return _tap; }
 
@@ -1,8 +1,24 @@
 #include "tcp_receiver.hh"
 
+#include "memory_budget.hh"
+
+#include <algorithm>
+#include <vector>
+
 using namespace std;
 
+//! \details The segment's timestamp becomes the one to echo if the segment
+//! starts at or before the ackno last sent to the peer (Last.ACK.sent in
+//! [RFC 7323](\ref rfc::rfc7323), section 4.3). Segments that arrive early,
+//! after a loss, would otherwise make the peer's RTT look shorter, and while
+//! an ACK is delayed, later in-order segments would replace the timestamp of
+//! the first one it covers.
 void TCPReceiver::segment_received(const TCPSegment &seg) {
+    if (seg.header().timestamp.has_value() && !paws_rejects(seg) &&
+        (_last_ack_sent.has_value() ? seg.header().seqno - _last_ack_sent.value() <= 0 : seg.header().syn)) {
+        _ts_recent = seg.header().timestamp->value;
+    }
+
     // Here, we should ensure we set the initial sequence number
     // when we first time receive the SYN.
     if (seg.header().syn) {
@@ -17,9 +33,15 @@ void TCPReceiver::segment_received(const TCPSegment &seg) {
     // stream_out().bytes_written() is always pointing to the
     // absolute current window size start
     if (_sender_isn.has_value()) {
-        _reassembler.push_substring(seg.payload().copy(),
-                                    unwrap(seg.header().seqno, _sender_isn.value(), stream_out().bytes_written()),
-                                    seg.header().fin);
+        // a segment merged on receive is pushed piece by piece, so its payload is never copied
+        uint64_t index = unwrap(seg.header().seqno, _sender_isn.value(), stream_out().bytes_written());
+        const vector<Buffer> &pieces = seg.merged_payload();
+        _reassembler.push_substring(seg.payload(), index, seg.header().fin && pieces.empty());
+        index += seg.payload().size();
+        for (size_t i = 0; i < pieces.size(); i++) {
+            _reassembler.push_substring(pieces[i], index, seg.header().fin && i + 1 == pieces.size());
+            index += pieces[i].size();
+        }
         _ack.emplace(wrap(stream_out().bytes_written(), _sender_isn.value()));
 
         // When we first accept the SYN, we should pay attention there is no
@@ -47,4 +69,46 @@ void TCPReceiver::segment_received(const TCPSegment &seg) {
 
 optional<WrappingInt32> TCPReceiver::ackno() const { return _ack; }
 
-size_t TCPReceiver::window_size() const { return stream_out().remaining_capacity(); }
+TCPHeader::SACKBlocks TCPReceiver::sack_blocks() const {
+    TCPHeader::SACKBlocks blocks{};
+    if (not _sender_isn.has_value()) {
+        return blocks;
+    }
+    // After the SYN, `_sender_isn` is the seqno of stream index 0.
+    for (const auto &range : _reassembler.out_of_order_ranges()) {
+        if (blocks.full()) {
+            break;
+        }
+        blocks.push_back({wrap(range.first, _sender_isn.value()), wrap(range.second, _sender_isn.value())});
+    }
+    return blocks;
+}
+
+//! \details Timestamps are compared modulo 2^32, like sequence numbers. RSTs
+//! are never rejected.
+bool TCPReceiver::paws_rejects(const TCPSegment &seg) const {
+    if (seg.header().rst || !seg.header().timestamp.has_value() || !_ts_recent.has_value()) {
+        return false;
+    }
+    return static_cast<int32_t>(seg.header().timestamp->value - _ts_recent.value()) < 0;
+}
+
+//! \details The window also stops growing (or closes) when the process-wide MemoryBudget
+//! runs low. But the right edge of a window already advertised never moves left
+//! ([RFC 7323](\ref rfc::rfc7323), section 2.4), since the peer may have data in
+//! flight up to it, so the pressure only holds back new growth.
+size_t TCPReceiver::window_size() const {
+    const size_t capacity = stream_out().remaining_capacity();
+    const size_t window = MemoryBudget::global().window(capacity);
+    if (!_ack.has_value() || !_window_edge.has_value()) {
+        return window;
+    }
+    const int32_t promised = _window_edge.value() - _ack.value();
+    return promised > 0 ? max(window, min<size_t>(promised, capacity)) : window;
+}
+
+void TCPReceiver::window_advertised(const WrappingInt32 right_edge) {
+    if (!_window_edge.has_value() || right_edge - _window_edge.value() > 0) {
+        _window_edge = right_edge;
+    }
+}
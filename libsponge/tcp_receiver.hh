@@ -20,8 +20,11 @@ class TCPReceiver {
     //! The maximum number of bytes we'll store.
     size_t _capacity;
 
-    std::optional<WrappingInt32> _sender_isn{};  //! The initial sequence number from the sender
-    std::optional<WrappingInt32> _ack{};         //! The acknowledge number
+    std::optional<WrappingInt32> _sender_isn{};     //! The initial sequence number from the sender
+    std::optional<WrappingInt32> _ack{};            //! The acknowledge number
+    std::optional<uint32_t> _ts_recent{};           //! The peer's timestamp to echo (TS.Recent)
+    std::optional<WrappingInt32> _window_edge{};    //! The right edge of the window advertised to the peer
+    std::optional<WrappingInt32> _last_ack_sent{};  //! The ackno of the latest ACK sent to the peer (Last.ACK.sent)
 
   public:
     //! \brief Construct a TCP receiver
@@ -51,8 +54,24 @@ class TCPReceiver {
     //! accepted by the receiver) and (b) the sequence number of the
     //! beginning of the window (the ackno).
     size_t window_size() const;
+
+    //! \brief Note the right edge of a window sent to the peer; window_size() never pulls back from it
+    void window_advertised(const WrappingInt32 right_edge);
+
+    //! \brief Note the ackno of an ACK sent to the peer; only segments starting at or before it set ts_recent()
+    void ack_sent(const WrappingInt32 ackno) { _last_ack_sent = ackno; }
+
+    //! \brief The [SACK](\ref rfc::rfc2018) blocks that should be sent to the peer
+    //! \returns the out-of-order ranges held beyond the ackno, the most recently received first
+    TCPHeader::SACKBlocks sack_blocks() const;
+
+    //! \brief The peer's [timestamp](\ref rfc::rfc7323) to echo, from the latest segment reaching the last ackno sent
+    std::optional<uint32_t> ts_recent() const { return _ts_recent; }
     //!@}
 
+    //! \brief Whether [PAWS](\ref rfc::rfc7323) rejects the segment: its timestamp is older than one already seen
+    bool paws_rejects(const TCPSegment &seg) const;
+
     //! \brief number of bytes stored but not yet reassembled
     size_t unassembled_bytes() const { return _reassembler.unassembled_bytes(); }
 
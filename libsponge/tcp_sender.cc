@@ -2,68 +2,126 @@
 
 #include "tcp_config.hh"
 
+#include <algorithm>
+#include <cmath>
 #include <random>
+#include <utility>
 
 using namespace std;
 
+namespace {
+
+TCPConfig sender_config(const size_t capacity, const uint16_t retx_timeout, const optional<WrappingInt32> fixed_isn) {
+    TCPConfig cfg{};
+    cfg.send_capacity = capacity;
+    cfg.rt_timeout = retx_timeout;
+    cfg.fixed_isn = fixed_isn;
+    return cfg;
+}
+
+}  // namespace
+
 //! \param[in] capacity the capacity of the outgoing byte stream
 //! \param[in] retx_timeout the initial amount of time to wait before retransmitting the oldest outstanding segment
 //! \param[in] fixed_isn the Initial Sequence Number to use, if set (otherwise uses a random ISN)
 TCPSender::TCPSender(const size_t capacity, const uint16_t retx_timeout, const std::optional<WrappingInt32> fixed_isn)
-    : _isn(fixed_isn.value_or(WrappingInt32{random_device()()}))
-    , _initial_retransmission_timeout{retx_timeout}
-    , _stream(capacity)
-    , _retransmission_timer{retx_timeout} {}
+    : TCPSender(sender_config(capacity, retx_timeout, fixed_isn)) {}
+
+//! \param[in] cfg the send capacity, timeouts, ISN, congestion control and loss recovery to use
+TCPSender::TCPSender(const TCPConfig &cfg)
+    : _isn(cfg.fixed_isn.value_or(WrappingInt32{random_device()()}))
+    , _initial_retransmission_timeout{cfg.rt_timeout}
+    , _stream(cfg.send_capacity)
+    , _retransmission_timer{cfg.adaptive_rto ? RetransmissionTimer{cfg.rt_timeout, cfg.min_rto, cfg.max_rto}
+                                             : RetransmissionTimer{cfg.rt_timeout}}
+    , _configured_mss(cfg.mss)
+    , _mss(cfg.mss)
+    , _congestion_algorithm(cfg.congestion_control)
+    , _congestion_controller(make_congestion_controller(_congestion_algorithm, _mss))
+    , _fast_retransmit(cfg.fast_retransmit)
+    , _pacing(cfg.pacing)
+    , _fixed_pacing_rate(static_cast<double>(cfg.pacing_rate) / 1000)
+    , _gso(cfg.gso)
+    , _persist(cfg.persist_timer)
+    , _max_persist_timeout(cfg.max_rto) {}
 
 uint64_t TCPSender::bytes_in_flight() const { return _next_seqno - _receiver_ack; }
 
 void TCPSender::fill_window() {
-    // Special case: we have already sent the `FIN`.
-    if (end) {
-        return;
+    // Special case: a closed window counts as one byte, unless the persist timer probes it
+    uint64_t window_size = _receiver_window_size == 0 && !_persist ? 1 : _receiver_window_size;
+    if (_congestion_controller) {
+        window_size = std::min<uint64_t>(window_size, _congestion_controller->cwnd() + _recovery_inflation);
     }
+    send_segments(window_size, pacing_rate().has_value());
+}
 
-    TCPSegment segment{};
+//! \details Segments are built in one pass over the window. Each payload is a
+//! slice of the outgoing stream's storage, shared with the outstanding segment
+//! kept for retransmission, so the bytes are neither copied nor allocated again.
+void TCPSender::send_segments(const uint64_t window_size, const bool paced) {
+    // Special case: we have already sent the `FIN`.
+    while (!end) {
+        TCPSegment segment{};
+        const uint64_t start = _next_seqno;
 
-    // Special case: when the `_receiver_window_size` equals 0
-    uint64_t window_size = _receiver_window_size == 0 ? 1 : _receiver_window_size;
+        // Special case : TCP connection
+        if (_next_seqno == 0) {
+            segment.header().syn = true;
+            segment.header().seqno = _isn + _next_seqno;
+            _next_seqno += 1;
+        } else {
+            // The window may have shrunk below what is already in flight
+            if (!window_not_full(window_size)) {
+                return;
+            }
 
-    // Special case : TCP connection
-    if (_next_seqno == 0) {
-        segment.header().syn = true;
-        segment.header().seqno = _isn + _next_seqno;
-        _next_seqno += 1;
-    } else {
-        // Find the length to read from the `stream_in()`
-        uint64_t length =
-            std::min(std::min(window_size - bytes_in_flight(), stream_in().buffer_size()), TCPConfig::MAX_PAYLOAD_SIZE);
-        segment.payload() = Buffer{std::move(stream_in().read(length))};
-        segment.header().seqno = _isn + _next_seqno;
-        _next_seqno += length;
-
-        // When the `stream_in` is end of file,  we need to set the `fin` to `true`.
-        // Pay attention, we should check whether there is an enough window size
-        if (stream_in().eof() && window_not_full(window_size)) {
-            segment.header().fin = true;
-            end = true;
-            _next_seqno++;
-        }
+            // Find the length to read from the `stream_in()`
+            uint64_t length =
+                std::min(std::min(window_size - bytes_in_flight(), stream_in().buffer_size()), max_segment_payload());
+
+            // Data waits for pacing tokens, which tick() hands out; a bare FIN doesn't
+            if (length > 0 && paced) {
+                if (_pacing_tokens <= 0) {
+                    return;
+                }
+                _pacing_tokens -= length;
+            }
+            segment.payload() = stream_in().read_buffer(length);
+            segment.header().seqno = _isn + _next_seqno;
+            if (length > _mss) {
+                segment.gso_size() = _mss;
+            }
+            _next_seqno += length;
 
-        // We should do nothing
-        if (length == 0 && !end)
+            // When the `stream_in` is end of file,  we need to set the `fin` to `true`.
+            // Pay attention, we should check whether there is an enough window size
+            if (stream_in().eof() && window_not_full(window_size)) {
+                segment.header().fin = true;
+                end = true;
+                _next_seqno++;
+            }
+
+            // We should do nothing
+            if (length == 0 && !end)
+                return;
+        }
+        _outstanding_segments.push_back(
+            {start, _next_seqno, segment.payload(), segment.header().syn, segment.header().fin, _time, false, false});
+        segments_out().push(std::move(segment));
+        _retransmission_timer.start_timer();
+        if (!window_not_full(window_size)) {
             return;
-    }
-    segments_out().push(segment);
-    _outstanding_segments.push_back(segment);
-    _retransmission_timer.start_timer();
-    if (window_not_full(window_size)) {
-        fill_window();
+        }
     }
 }
 
 //! \param ackno The remote receiver's ackno (acknowledgment number)
-//! \param window_size The remote receiver's advertised window size
-void TCPSender::ack_received(const WrappingInt32 ackno, const uint16_t window_size) {
+//! \param window_size The remote receiver's advertised window size, already scaled ([RFC 7323](\ref rfc::rfc7323))
+//! \param pure_ack Whether the segment carried nothing but the ACK
+void TCPSender::ack_received(const WrappingInt32 ackno, const uint64_t window_size, const bool pure_ack) {
+    const optional<uint64_t> echoed_rtt = exchange(_echoed_rtt, {});
+
     // When receiving unneeded ack, just return.
     if (unwrap(ackno, _isn, next_seqno_absolute()) > _next_seqno ||
         unwrap(ackno, _isn, next_seqno_absolute()) < _receiver_ack) {
@@ -71,19 +129,72 @@ void TCPSender::ack_received(const WrappingInt32 ackno, const uint16_t window_si
     }
 
     uint64_t absolute_ack = unwrap(ackno, _isn, next_seqno_absolute());
+
+    // RFC 5681: a duplicate ACK repeats the ackno and window while data is outstanding
+    // (a closed window holds everything back, so an ACK of it says nothing about loss)
+    if (_fast_retransmit && pure_ack && absolute_ack == _receiver_ack && window_size == _receiver_window_size &&
+        window_size != 0 && !_outstanding_segments.empty()) {
+        duplicate_ack_received();
+        return;
+    }
+
     _receiver_window_size = window_size;
+    // a segment ACKed only in part (some of a GSO segment's wire segments, or the byte a
+    // window probe carried) is split, so the ACKed part leaves and the rest starts at the ackno
+    if (_gso || (_persist && window_size == 0)) {
+        split_outstanding(absolute_ack);
+    }
     bool is_ack_update = false;
+    const uint64_t previous_ack = _receiver_ack;
+    optional<uint64_t> rtt{};
+    bool acked_retransmission = false;
+
+    // The segments are in seqno order, so the fully acknowledged ones are all at the front.
+    while (!_outstanding_segments.empty() && _outstanding_segments.front().end <= absolute_ack) {
+        const OutstandingSegment &acked = _outstanding_segments.front();
+        _receiver_ack = acked.end;
+        acked_retransmission |= acked.retransmitted;
+        rtt = _time - acked.sent_at;
+        _outstanding_segments.pop_front();
+        is_ack_update = true;
+    }
 
-    auto iter = _outstanding_segments.begin();
-    while (iter != _outstanding_segments.end()) {
-        uint64_t sequence_num = unwrap(iter->header().seqno, _isn, next_seqno_absolute());
-        if (sequence_num + iter->length_in_sequence_space() <= absolute_ack) {
-            _receiver_ack = sequence_num + iter->length_in_sequence_space();
-            iter = _outstanding_segments.erase(iter);
-            is_ack_update = true;
+    // Karn's rule: an ACK that covers a resent segment might be for either copy, and
+    // if it filled a hole it was held back by the loss, so it gives no RTT sample
+    if (acked_retransmission) {
+        rtt.reset();
+    }
+    // a timestamp echo tells which copy was acknowledged, so it always gives a sample
+    if (is_ack_update && echoed_rtt.has_value()) {
+        rtt = echoed_rtt;
+    }
+
+    // the SYN gives an RTT sample, but doesn't count as delivered data
+    const uint64_t acked = _receiver_ack - std::max<uint64_t>(previous_ack, 1);
+    const bool recovering = _in_recovery;
+    if (is_ack_update) {
+        _duplicate_acks = 0;
+    }
+
+    // RFC 6582: an ACK short of `_recover` shows the next hole, which is resent at once;
+    // the window deflates by the data it acknowledged, plus one segment for the one that left
+    if (is_ack_update && _in_recovery) {
+        if (_receiver_ack >= _recover) {
+            _in_recovery = false;
+            _recovery_inflation = 0;
         } else {
-            iter++;
+            _recovery_inflation = (_recovery_inflation > acked ? _recovery_inflation - acked : 0) + _mss;
+            if (!retransmit_next_hole() && _outstanding_segments.front().start >= _retransmit_cursor) {
+                retransmit_front();
+            }
         }
+    } else if (is_ack_update && _receiver_ack < _recover) {
+        // after a timeout, the holes the scoreboard shows are resent as ACKs arrive
+        retransmit_next_hole();
+    }
+
+    if (is_ack_update && _congestion_controller) {
+        _congestion_controller->on_ack({_time, acked, bytes_in_flight(), rtt, recovering});
     }
 
     // When there is no outstanding segments, we should stop the timer
@@ -94,22 +205,294 @@ void TCPSender::ack_received(const WrappingInt32 ackno, const uint16_t window_si
     // When the receiver gives the sender an ackno that acknowledges
     // the successful receipt of new data
     if (is_ack_update) {
+        if (rtt.has_value()) {
+            _retransmission_timer.rtt_sample(*rtt);
+        }
         _retransmission_timer.reset_timer();
         _consecutive_retransmissions = 0;
     }
+    update_persist_timer();
+}
+
+//! \details [RFC 1122](\ref rfc::rfc1122), section 4.2.2.17: while the peer's window
+//! is closed, the retransmission timer is stopped and the persist timer probes it
+//! instead, backing off from the RTO up to the largest timeout. Any ACK shows the
+//! peer is still there, so it resets the count of unanswered probes; an ACK that
+//! opens the window stops the timer, and fill_window() sends again at once.
+void TCPSender::update_persist_timer() {
+    if (!_persist) {
+        return;
+    }
+    if (_receiver_window_size != 0) {
+        if (_persist_elapsed.has_value() && !_outstanding_segments.empty()) {
+            _retransmission_timer.start_timer();
+        }
+        _persist_elapsed.reset();
+        return;
+    }
+    if (!_persist_elapsed.has_value()) {
+        _persist_elapsed = 0;
+        _persist_timeout = _retransmission_timer.rto();
+    }
+    _retransmission_timer.stop_timer();
+    _consecutive_retransmissions = 0;
+}
+
+//! \details The probe is the first byte of the oldest outstanding segment, or,
+//! with nothing in flight, the next byte of the stream (or the FIN). A probe
+//! doesn't wait for pacing, whose rate a closed window would bring to zero.
+bool TCPSender::send_window_probe() {
+    if (_outstanding_segments.empty()) {
+        const uint64_t next_seqno = _next_seqno;
+        send_segments(1, false);
+        _retransmission_timer.stop_timer();
+        return _next_seqno != next_seqno;
+    }
+    OutstandingSegment &front = _outstanding_segments.front();
+    TCPSegment probe{};
+    probe.header().seqno = _isn + front.start;
+    probe.payload() = front.payload;
+    if (probe.payload().size() > 1) {
+        probe.payload().remove_suffix(probe.payload().size() - 1);
+    } else {
+        probe.header().fin = front.fin;
+    }
+    front.retransmitted = true;
+    segments_out().push(std::move(probe));
+    return true;
 }
 
 //! \param[in] ms_since_last_tick the number of milliseconds since the last call to this method
 void TCPSender::tick(const size_t ms_since_last_tick) {
+    _time += ms_since_last_tick;
+    const optional<double> rate = pacing_rate();
+    if (rate.has_value()) {
+        // a long tick lets out all it was worth, but an idle sender saves up two segments at most
+        const double accrued = *rate * ms_since_last_tick;
+        const double depth = stream_in().buffer_empty() ? 2.0 * _mss : std::max(2.0 * _mss, accrued);
+        _pacing_tokens = std::min(_pacing_tokens + accrued, depth);
+    }
+    if (_persist_elapsed.has_value()) {
+        *_persist_elapsed += ms_since_last_tick;
+        if (*_persist_elapsed >= _persist_timeout) {
+            _persist_elapsed = 0;
+            if (send_window_probe()) {
+                _persist_timeout = std::min(2 * _persist_timeout, _max_persist_timeout);
+                _consecutive_retransmissions++;
+            }
+        }
+    }
     if (_retransmission_timer.tick_callback(ms_since_last_tick)) {
         if (_receiver_window_size == 0) {
             _retransmission_timer.reset_timer();
         } else {
             _retransmission_timer.handle_expired();
+            if (_congestion_controller) {
+                _congestion_controller->on_timeout(_time, bytes_in_flight());
+            }
+            // a timeout ends any recovery, and duplicate ACKs for what was sent before it start none
+            _in_recovery = false;
+            _recovery_inflation = 0;
+            _duplicate_acks = 0;
+            _recover = _next_seqno;
+            _retransmit_cursor = _receiver_ack;
         }
         _consecutive_retransmissions++;
-        segments_out().push(_outstanding_segments.front());
+        retransmit_front();
+    }
+    if (rate.has_value() && _next_seqno > 0) {
+        fill_window();
+    }
+}
+
+//! \details A configured rate wins, then the congestion controller's (BBR paces,
+//! once it has measured some delivery), and otherwise twice the window per smoothed RTT, so that slow start, which
+//! doubles the window every round trip, isn't held back. Until there is an RTT
+//! sample, nothing is paced.
+optional<double> TCPSender::pacing_rate() const {
+    if (!_pacing) {
+        return {};
+    }
+    if (_fixed_pacing_rate > 0) {
+        return _fixed_pacing_rate;
+    }
+    const optional<double> controller_rate =
+        _congestion_controller ? _congestion_controller->pacing_rate() : optional<double>{};
+    if (controller_rate.value_or(0) > 0) {
+        return controller_rate;
+    }
+    const optional<double> srtt = _retransmission_timer.srtt();
+    if (!srtt.has_value()) {
+        return {};
+    }
+    const double window = _congestion_controller ? _congestion_controller->cwnd() : _receiver_window_size;
+    if (window <= 0) {
+        return {};
+    }
+    return 2 * window / std::max(*srtt, 1.0);
+}
+
+optional<size_t> TCPSender::time_until_paced_send() const {
+    const optional<double> rate = pacing_rate();
+    if (!rate.has_value() || *rate <= 0 || _pacing_tokens > 0 || stream_in().buffer_empty()) {
+        return {};
+    }
+    return std::max<size_t>(1, static_cast<size_t>(std::ceil(-_pacing_tokens / *rate)));
+}
+
+//! \details With GSO, a segment holds as many whole MSS-sized pieces as
+//! GSO_MAX_SIZE does, or, while paced, as the pacing tokens allow.
+size_t TCPSender::max_segment_payload() const {
+    if (!_gso) {
+        return _mss;
+    }
+    size_t pieces = TCPConfig::GSO_MAX_SIZE / _mss;
+    if (pacing_rate().has_value()) {
+        pieces = std::min(pieces, static_cast<size_t>(std::max(_pacing_tokens, 0.0)) / _mss);
+    }
+    return std::max<size_t>(pieces, 1) * _mss;
+}
+
+//! \details With GSO, an outstanding segment stands for many wire segments, any of
+//! which may be ACKed, SACKed or lost on its own. It is split where that
+//! happens, so the scoreboard and retransmissions stay as fine as the wire.
+//! A closed window splits any segment whose front a probe delivered, so the
+//! next probe carries the first byte not yet ACKed.
+void TCPSender::split_outstanding(const uint64_t seqno) {
+    auto it = upper_bound(_outstanding_segments.begin(),
+                          _outstanding_segments.end(),
+                          seqno,
+                          [](const uint64_t value, const OutstandingSegment &seg) { return value < seg.start; });
+    if (it == _outstanding_segments.begin()) {
+        return;
+    }
+    --it;
+    if (seqno <= it->start || seqno >= it->end) {
+        return;
+    }
+    OutstandingSegment tail = *it;
+    const size_t head_length = seqno - it->start - (it->syn ? 1 : 0);
+    it->end = seqno;
+    it->fin = false;
+    it->payload.remove_suffix(it->payload.size() - head_length);
+    tail.start = seqno;
+    tail.syn = false;
+    tail.payload.remove_prefix(head_length);
+    _outstanding_segments.insert(it + 1, std::move(tail));
+}
+
+void TCPSender::retransmit(OutstandingSegment &outstanding) {
+    TCPSegment segment{};
+    segment.header().seqno = _isn + outstanding.start;
+    segment.header().syn = outstanding.syn;
+    segment.header().fin = outstanding.fin;
+    segment.payload() = outstanding.payload;
+    outstanding.retransmitted = true;
+    segments_out().push(std::move(segment));
+}
+
+void TCPSender::retransmit_front() {
+    if (_gso) {
+        split_outstanding(_outstanding_segments.front().start + _mss);
+    }
+    OutstandingSegment &front = _outstanding_segments.front();
+    _retransmit_cursor = max(_retransmit_cursor, front.end);
+    retransmit(front);
+}
+
+//! \details This is rule 1 of NextSeg() in [RFC 6675](\ref rfc::rfc6675): the first
+//! segment past the ones already resent that isn't SACKed but has SACKed data above it.
+//! The segments are in seqno order, so the search starts with a binary search.
+bool TCPSender::retransmit_next_hole() {
+    auto it = lower_bound(_outstanding_segments.begin(),
+                          _outstanding_segments.end(),
+                          _retransmit_cursor,
+                          [](const OutstandingSegment &seg, const uint64_t seqno) { return seg.start < seqno; });
+    for (; it != _outstanding_segments.end() && it->end <= _high_sacked; ++it) {
+        if (!it->sacked) {
+            // resend one MSS of a larger hole at a time
+            const size_t index = it - _outstanding_segments.begin();
+            if (_gso) {
+                split_outstanding(it->start + _mss);
+            }
+            OutstandingSegment &hole = _outstanding_segments[index];
+            _retransmit_cursor = hole.end;
+            retransmit(hole);
+            return true;
+        }
+    }
+    return false;
+}
+
+//! \param blocks The SACK blocks from the peer's segment
+//! \details Blocks that reach outside the outstanding data are ignored. A segment
+//! counts as SACKed only if a block covers all of it.
+void TCPSender::sack_received(const TCPHeader::SACKBlocks &blocks) {
+    for (const auto &block : blocks) {
+        const uint64_t left = unwrap(block.left, _isn, _next_seqno);
+        const uint64_t right = unwrap(block.right, _isn, _next_seqno);
+        if (left >= right || left < _receiver_ack || right > _next_seqno) {
+            continue;
+        }
+        if (_gso) {
+            split_outstanding(left);
+            split_outstanding(right);
+        }
+        auto it = lower_bound(_outstanding_segments.begin(),
+                              _outstanding_segments.end(),
+                              left,
+                              [](const OutstandingSegment &seg, const uint64_t seqno) { return seg.start < seqno; });
+        for (; it != _outstanding_segments.end() && it->end <= right; ++it) {
+            it->sacked = true;
+            _high_sacked = max(_high_sacked, it->end);
+        }
+    }
+}
+
+//! \details The third duplicate ACK resends the segment the receiver is missing
+//! (fast retransmit) and starts a recovery in which every further duplicate ACK,
+//! standing for a segment that left the network, lets a new one be sent
+//! (fast recovery). With SACK, each of those duplicates also resends the next
+//! hole. A recovery isn't started again by ACKs for data that was outstanding
+//! when the last one started.
+void TCPSender::duplicate_ack_received() {
+    _duplicate_acks++;
+    if (_in_recovery) {
+        _recovery_inflation += _mss;
+        retransmit_next_hole();
+        return;
+    }
+    if (_duplicate_acks != 3 || _receiver_ack < _recover) {
+        return;
+    }
+    _in_recovery = true;
+    _recover = _next_seqno;
+    _retransmit_cursor = _receiver_ack;
+    _recovery_inflation = 3 * _mss;
+    if (_congestion_controller) {
+        _congestion_controller->on_loss(_time, bytes_in_flight());
+    }
+    retransmit_front();
+}
+
+//! \param[in] peer_mss the largest payload the peer will accept, or 0 if its SYN had no MSS option
+//! \param[in] option_space the bytes of options on every segment (e.g. timestamps), which the MSS must make room for
+//! \details The segment size only shrinks, and only during the handshake: the
+//! congestion controller is created afresh, so its initial window is counted in
+//! the new segment size. The MSS counts payload without options, so options sent on
+//! every segment come out of it ([RFC 6691](\ref rfc::rfc6691)). A retransmitted SYN
+//! sets the same size again.
+void TCPSender::set_mss(const uint16_t peer_mss, const size_t option_space) {
+    if (_receiver_ack > 0) {
+        return;
+    }
+    const size_t mss = peer_mss == 0 ? _configured_mss : std::min<size_t>(peer_mss, _configured_mss);
+    const size_t payload = mss > option_space ? mss - option_space : 1;
+    if (payload == _mss) {
+        return;
     }
+    _mss = payload;
+    _congestion_controller = make_congestion_controller(_congestion_algorithm, _mss);
 }
 
 unsigned int TCPSender::consecutive_retransmissions() const { return _consecutive_retransmissions; }
@@ -2,13 +2,15 @@
 #define SPONGE_LIBSPONGE_TCP_SENDER_HH
 
 #include "byte_stream.hh"
+#include "congestion_control.hh"
 #include "retransmission_timer.hh"
 #include "tcp_config.hh"
 #include "tcp_segment.hh"
 #include "wrapping_integers.hh"
 
+#include <deque>
 #include <functional>
-#include <list>
+#include <memory>
 #include <queue>
 
 //! \brief The "sender" part of a TCP implementation.
@@ -16,9 +18,25 @@
 //! Accepts a ByteStream, divides it up into segments and sends the
 //! segments, keeps track of which segments are still in-flight,
 //! maintains the Retransmission Timer, and retransmits in-flight
-//! segments if the retransmission timer expires.
+//! segments if the retransmission timer expires. When the peer SACKs,
+//! the in-flight segments double as a scoreboard, so that only the
+//! holes are retransmitted.
 class TCPSender {
   private:
+    //! \brief A segment that has been sent but not yet fully acknowledged
+    //! \details The payload shares its storage with the segment that was sent,
+    //! so the segment can be rebuilt for a retransmission without copying it.
+    struct OutstandingSegment {
+        uint64_t start;      //!< the absolute seqno of its first byte (or SYN)
+        uint64_t end;        //!< the absolute seqno just past its last byte (or FIN)
+        Buffer payload;      //!< the payload, for retransmission
+        bool syn;            //!< whether it carries the SYN
+        bool fin;            //!< whether it carries the FIN
+        uint64_t sent_at;    //!< when it was first sent, on the sender's clock
+        bool retransmitted;  //!< whether it was sent more than once (so it gives no RTT sample)
+        bool sacked;         //!< whether the receiver reported holding it in a SACK block
+    };
+
     //! our initial sequence number, the number for our SYN.
     WrappingInt32 _isn;
 
@@ -46,12 +64,102 @@ class TCPSender {
     //! the initial window size should be 1
     uint64_t _receiver_window_size{1};
 
-    //! the outstanding segments
-    std::list<TCPSegment> _outstanding_segments{};
+    //! the outstanding segments, in seqno order
+    std::deque<OutstandingSegment> _outstanding_segments{};
 
     //! the consecutive retransmissions
     unsigned int _consecutive_retransmissions{0};
 
+    //! the milliseconds that have passed, as told by tick()
+    uint64_t _time{0};
+
+    //! the MSS we advertise, before the peer's MSS and our options take their share
+    size_t _configured_mss;
+
+    //! the largest payload to put in a segment
+    size_t _mss;
+
+    //! which congestion control algorithm to run
+    CongestionControl _congestion_algorithm;
+
+    //! the congestion control algorithm, or nullptr to send whatever the receiver's window allows
+    std::unique_ptr<CongestionController> _congestion_controller;
+
+    //! whether duplicate ACKs trigger a fast retransmit
+    bool _fast_retransmit;
+
+    //! the duplicate ACKs received since the ackno last moved
+    unsigned int _duplicate_acks{0};
+
+    //! whether a fast retransmit started a recovery that is not yet over
+    bool _in_recovery{false};
+
+    //! the (absolute) seqno that must be acknowledged to end the recovery ([RFC 6582](\ref rfc::rfc6582))
+    uint64_t _recover{0};
+
+    //! bytes the congestion window is inflated by during a recovery, for the segments that left the network
+    uint64_t _recovery_inflation{0};
+
+    //! the (absolute) seqno just past the highest byte the receiver has SACKed
+    uint64_t _high_sacked{0};
+
+    //! the (absolute) seqno below which every hole was already resent since the last loss was detected
+    uint64_t _retransmit_cursor{0};
+
+    //! whether new segments are paced out
+    bool _pacing;
+
+    //! the configured pacing rate, in bytes per millisecond, or 0 to derive one
+    double _fixed_pacing_rate;
+
+    //! the bytes the pacing token bucket lets through; a segment may overdraw it
+    double _pacing_tokens{0};
+
+    //! the RTT the peer's timestamp echo gives for the ACK about to arrive
+    std::optional<uint64_t> _echoed_rtt{};
+
+    //! whether segments are built larger than the MSS, for the adapter to split (GSO)
+    bool _gso;
+
+    //! whether a closed window is probed on the persist timer, instead of being treated as one byte
+    bool _persist;
+
+    //! how long the persist timer has run, while the peer's window is closed
+    std::optional<size_t> _persist_elapsed{};
+
+    //! how long the persist timer runs before the next window probe
+    size_t _persist_timeout{0};
+
+    //! the longest the persist timeout backs off to
+    size_t _max_persist_timeout;
+
+    //! send segments to fill `window_size`, waiting for pacing tokens if `paced`
+    void send_segments(const uint64_t window_size, const bool paced);
+
+    //! start or stop the persist timer as the peer's window closes or opens
+    void update_persist_timer();
+
+    //! send a one-byte segment into the closed window, and tell whether there was anything to send
+    bool send_window_probe();
+
+    //! the largest payload of a segment to build
+    size_t max_segment_payload() const;
+
+    //! split the outstanding segment that holds `seqno` past its start in two, at `seqno`
+    void split_outstanding(const uint64_t seqno);
+
+    //! rebuild an outstanding segment, and mark it as resent
+    void retransmit(OutstandingSegment &outstanding);
+
+    //! resend the oldest outstanding segment
+    void retransmit_front();
+
+    //! resend the next hole the SACK scoreboard shows, if there is one
+    bool retransmit_next_hole();
+
+    //! count a duplicate ACK, and fast-retransmit on the third
+    void duplicate_ack_received();
+
     //! a helper function to tell whether the window is not full
     bool window_not_full(uint64_t window_size) const { return window_size > bytes_in_flight(); }
 
@@ -61,6 +169,9 @@ class TCPSender {
               const uint16_t retx_timeout = TCPConfig::TIMEOUT_DFLT,
               const std::optional<WrappingInt32> fixed_isn = {});
 
+    //! Initialize a TCPSender from the sender's part of a TCPConfig
+    explicit TCPSender(const TCPConfig &cfg);
+
     //! \name "Input" interface for the writer
     //!@{
     ByteStream &stream_in() { return _stream; }
@@ -71,7 +182,17 @@ class TCPSender {
     //!@{
 
     //! \brief A new acknowledgment was received
-    void ack_received(const WrappingInt32 ackno, const uint16_t window_size);
+    //! \param pure_ack whether the segment carrying it had no payload, SYN or FIN (only those can be duplicate ACKs)
+    void ack_received(const WrappingInt32 ackno, const uint64_t window_size, const bool pure_ack = true);
+
+    //! \brief The peer's [SACK](\ref rfc::rfc2018) blocks arrived, ahead of the ACK that carries them
+    void sack_received(const TCPHeader::SACKBlocks &blocks);
+
+    //! \brief The ACK about to arrive echoed one of our [timestamps](\ref rfc::rfc7323), `rtt` milliseconds old
+    void echoed_rtt_received(const uint64_t rtt) { _echoed_rtt = rtt; }
+
+    //! \brief The peer's SYN arrived: its MSS option, and the options on every segment, may lower the segment size
+    void set_mss(const uint16_t peer_mss, const size_t option_space = 0);
 
     //! \brief Generate an empty-payload segment (useful for creating empty ACK segments)
     void send_empty_segment();
@@ -94,6 +215,21 @@ class TCPSender {
     //! \brief Number of consecutive retransmissions that have occurred in a row
     unsigned int consecutive_retransmissions() const;
 
+    //! \brief The largest payload the sender puts in a segment
+    size_t mss() const { return _mss; }
+
+    //! \brief Whether the sender is recovering from a fast retransmit
+    bool in_recovery() const { return _in_recovery; }
+
+    //! \brief The rate new segments are paced out at, in bytes per millisecond, if pacing is on and a rate is known
+    std::optional<double> pacing_rate() const;
+
+    //! \brief How long until pacing lets the next segment out, if one is held back
+    std::optional<size_t> time_until_paced_send() const;
+
+    //! \brief The congestion control algorithm, if one is in use
+    const CongestionController *congestion_controller() const { return _congestion_controller.get(); }
+
     //! \brief TCPSegments that the TCPSender has enqueued for transmission.
     //! \note These must be dequeued and sent by the TCPConnection,
     //! which will need to fill in the fields that are set by the TCPReceiver
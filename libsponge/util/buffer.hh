@@ -16,12 +16,23 @@ class Buffer {
   private:
     std::shared_ptr<std::string> _storage{};
     size_t _starting_offset{};
+    size_t _ending_offset{};
 
   public:
     Buffer() = default;
 
     //! \brief Construct by taking ownership of a string
-    Buffer(std::string &&str) noexcept : _storage(std::make_shared<std::string>(std::move(str))) {}
+    Buffer(std::string &&str) noexcept
+        : _storage(std::make_shared<std::string>(std::move(str))), _ending_offset(_storage->size()) {}
+
+    //! \brief Construct a view of `length` bytes of shared storage, starting at `offset`
+    //! \note The bytes in the view must not be modified while any copy of the Buffer exists.
+    Buffer(std::shared_ptr<std::string> storage, const size_t offset, const size_t length)
+        : _storage(std::move(storage)), _starting_offset(offset), _ending_offset(offset + length) {
+        if (not _storage or _ending_offset > _storage->size()) {
+            throw std::out_of_range("Buffer: view exceeds its storage");
+        }
+    }
 
     //! \name Expose contents as a std::string_view
     //!@{
@@ -29,7 +40,7 @@ class Buffer {
         if (not _storage) {
             return {};
         }
-        return {_storage->data() + _starting_offset, _storage->size() - _starting_offset};
+        return {_storage->data() + _starting_offset, _ending_offset - _starting_offset};
     }
 
     operator std::string_view() const { return str(); }
@@ -44,9 +55,16 @@ class Buffer {
     //! \brief Make a copy to a new std::string
     std::string copy() const { return std::string(str()); }
 
+    //! \brief The string the view is into, shared with every copy of the Buffer
+    const std::shared_ptr<std::string> &storage() const { return _storage; }
+
     //! \brief Discard the first `n` bytes of the string (does not require a copy or move)
     //! \note Doesn't free any memory until the whole string has been discarded in all copies of the Buffer.
     void remove_prefix(const size_t n);
+
+    //! \brief Discard the last `n` bytes of the string (does not require a copy or move)
+    //! \note Like remove_prefix(), the storage is shared with every other copy of the Buffer.
+    void remove_suffix(const size_t n);
 };
 
 //! \brief A reference-counted discontiguous string that can discard bytes from the front
@@ -3,6 +3,7 @@
 #include "util.hh"
 
 #include <algorithm>
+#include <cerrno>
 #include <fcntl.h>
 #include <iostream>
 #include <stdexcept>
@@ -46,12 +47,18 @@ FileDescriptor FileDescriptor::duplicate() const { return FileDescriptor(_intern
 
 //! \param[in] limit is the maximum number of bytes to read; fewer bytes may be returned
 //! \param[out] str is the string to be read
+//! \details On a non-blocking fd with nothing to read, `str` comes back empty and the
+//! read isn't counted in read_count().
 void FileDescriptor::read(std::string &str, const size_t limit) {
     constexpr size_t BUFFER_SIZE = 1024 * 1024;  // maximum size of a read
     const size_t size_to_read = min(BUFFER_SIZE, limit);
     str.resize(size_to_read);
 
-    ssize_t bytes_read = SystemCall("read", ::read(fd_num(), str.data(), size_to_read));
+    ssize_t bytes_read = SystemCall("read", ::read(fd_num(), str.data(), size_to_read), EAGAIN);
+    if (bytes_read < 0) {
+        str.clear();
+        return;
+    }
     if (limit > 0 && bytes_read == 0) {
         _internal_fd->_eof = true;
     }
@@ -63,6 +70,27 @@ void FileDescriptor::read(std::string &str, const size_t limit) {
     register_read();
 }
 
+//! \param[in] regions are filled in order by [readv(2)](\ref man2::readv); fewer bytes may be read
+//! \returns the number of bytes read
+size_t FileDescriptor::read(const vector<iovec> &regions) {
+    size_t size_to_read = 0;
+    for (const auto &region : regions) {
+        size_to_read += region.iov_len;
+    }
+
+    ssize_t bytes_read = SystemCall("readv", ::readv(fd_num(), regions.data(), regions.size()));
+    if (size_to_read > 0 && bytes_read == 0) {
+        _internal_fd->_eof = true;
+    }
+    if (bytes_read > static_cast<ssize_t>(size_to_read)) {
+        throw runtime_error("readv() read more than requested");
+    }
+
+    register_read();
+
+    return bytes_read;
+}
+
 //! \param[in] limit is the maximum number of bytes to read; fewer bytes may be returned
 //! \returns a vector of bytes read
 string FileDescriptor::read(const size_t limit) {
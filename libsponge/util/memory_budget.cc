@@ -0,0 +1,104 @@
+#include "memory_budget.hh"
+
+#include "buffer.hh"
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+
+using namespace std;
+
+namespace {
+
+//! The deleter of storage charged to a budget, which returns the charge when the storage is freed
+struct ChargedStorage {
+    MemoryBudget &budget;
+    size_t charge;
+    shared_ptr<string> adopted;  //!< the storage, if it was adopted rather than allocated by the budget
+
+    void operator()(string *storage) {
+        budget.release(charge);
+        if (adopted) {
+            adopted.reset();
+        } else {
+            delete storage;
+        }
+    }
+};
+
+}  // namespace
+
+//! \param[in] high_watermark the charge at which the budget comes under pressure
+//! \param[in] low_watermark the charge at which the pressure ends
+MemoryBudget::MemoryBudget(const size_t high_watermark, const size_t low_watermark)
+    : _high_watermark(high_watermark), _low_watermark(low_watermark) {
+    set_watermarks(high_watermark, low_watermark);
+}
+
+MemoryBudget &MemoryBudget::global() {
+    static MemoryBudget budget{numeric_limits<size_t>::max(), numeric_limits<size_t>::max()};
+    return budget;
+}
+
+void MemoryBudget::set_watermarks(const size_t high_watermark, const size_t low_watermark) {
+    if (low_watermark > high_watermark) {
+        throw runtime_error("MemoryBudget: low watermark above high watermark");
+    }
+    _high_watermark.store(high_watermark, memory_order_relaxed);
+    _low_watermark.store(low_watermark, memory_order_relaxed);
+    if (in_use() >= high_watermark) {
+        _under_pressure.store(true, memory_order_relaxed);
+    } else if (in_use() <= low_watermark) {
+        _under_pressure.store(false, memory_order_relaxed);
+    }
+}
+
+void MemoryBudget::charge(const size_t len) {
+    const size_t in_use = _in_use.fetch_add(len, memory_order_relaxed) + len;
+    if (in_use >= _high_watermark.load(memory_order_relaxed)) {
+        _under_pressure.store(true, memory_order_relaxed);
+    }
+}
+
+void MemoryBudget::release(const size_t len) {
+    const size_t in_use = _in_use.fetch_sub(len, memory_order_relaxed) - len;
+    if (in_use <= _low_watermark.load(memory_order_relaxed)) {
+        _under_pressure.store(false, memory_order_relaxed);
+    }
+}
+
+//! \details The storage's deleter releases the charge, so it lasts as long as
+//! any Buffer that shares the storage, not just as long as the stream that made it.
+shared_ptr<string> MemoryBudget::make_chunk(const size_t len) {
+    auto chunk = shared_ptr<string>(new string(len, 0), ChargedStorage{*this, len, {}});
+    charge(len);
+    return chunk;
+}
+
+//! \details A slice keeps its whole string allocated, so the charge is the size of
+//! the string, not of the slice. The returned Buffer views the same bytes through
+//! a handle that holds the original storage and carries the charge; storage that
+//! is already charged (from make_chunk() or an earlier adopt()) is returned as-is.
+Buffer MemoryBudget::adopt(const Buffer &buffer) {
+    const shared_ptr<string> &storage = buffer.storage();
+    if (!storage || get_deleter<ChargedStorage>(storage) != nullptr) {
+        return buffer;
+    }
+    const size_t offset = buffer.str().data() - storage->data();
+    charge(storage->size());
+    shared_ptr<string> charged{storage.get(), ChargedStorage{*this, storage->size(), storage}};
+    return Buffer{move(charged), offset, buffer.size()};
+}
+
+//! \param[in] capacity the free space in the receiver's stream
+//! \details Outside of pressure, the window is also limited to the room left below
+//! the high watermark; under pressure it is closed.
+size_t MemoryBudget::window(const size_t capacity) const {
+    if (under_pressure()) {
+        return 0;
+    }
+    const size_t high_watermark = _high_watermark.load(memory_order_relaxed);
+    const size_t current = in_use();
+    return current >= high_watermark ? 0 : min(capacity, high_watermark - current);
+}
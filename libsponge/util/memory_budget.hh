@@ -0,0 +1,72 @@
+#ifndef SPONGE_LIBSPONGE_MEMORY_BUDGET_HH
+#define SPONGE_LIBSPONGE_MEMORY_BUDGET_HH
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <string>
+
+class Buffer;
+
+//! \brief A limit on the memory that byte streams may hold, shared by every connection.
+
+//! Storage from make_chunk() is charged to the budget until it is freed, and
+//! so is storage from elsewhere (such as a received datagram) that a stream
+//! holds on to through adopt().
+//! When the charges reach the high watermark the budget is "under
+//! pressure", and it stays that way until they fall back to the low
+//! watermark. Receivers consult window() so that, under pressure, peers
+//! are asked to stop sending until applications drain what is buffered.
+//!
+//! The counters are atomic, so the budget can be shared by connections
+//! running on different threads.
+class MemoryBudget {
+  private:
+    std::atomic<size_t> _in_use{0};            //!< the bytes currently charged
+    std::atomic<size_t> _high_watermark;       //!< the charge at which pressure starts
+    std::atomic<size_t> _low_watermark;        //!< the charge at which pressure ends
+    std::atomic<bool> _under_pressure{false};  //!< whether the high watermark was hit since the low one
+
+  public:
+    //! Create a budget that comes under pressure at `high_watermark` bytes and recovers at `low_watermark`
+    MemoryBudget(const size_t high_watermark, const size_t low_watermark);
+
+    //! \returns the budget shared by the whole process (unlimited until set_watermarks() is called)
+    static MemoryBudget &global();
+
+    //! Change both watermarks; throws if `low_watermark` is above `high_watermark`
+    void set_watermarks(const size_t high_watermark, const size_t low_watermark);
+
+    //! Charge `len` bytes to the budget
+    void charge(const size_t len);
+
+    //! Return `len` previously charged bytes to the budget
+    void release(const size_t len);
+
+    //! Allocate `len` zeroed bytes that stay charged to the budget until the last owner lets go
+    std::shared_ptr<std::string> make_chunk(const size_t len);
+
+    //! Charge the whole string behind `buffer` to the budget, until the last copy of the returned Buffer lets go
+    Buffer adopt(const Buffer &buffer);
+
+    //! \returns the bytes currently charged
+    size_t in_use() const { return _in_use.load(std::memory_order_relaxed); }
+
+    //! \returns `true` from when the high watermark is reached until the charges fall to the low one
+    bool under_pressure() const { return _under_pressure.load(std::memory_order_relaxed); }
+
+    //! \returns the window a receiver with `capacity` free bytes should advertise
+    size_t window(const size_t capacity) const;
+
+    //! \name
+    //! A MemoryBudget is shared by reference, so it cannot be copied or moved
+
+    //!@{
+    MemoryBudget(const MemoryBudget &other) = delete;
+    MemoryBudget &operator=(const MemoryBudget &other) = delete;
+    MemoryBudget(MemoryBudget &&other) = delete;
+    MemoryBudget &operator=(MemoryBudget &&other) = delete;
+    //!@}
+};
+
+#endif  // SPONGE_LIBSPONGE_MEMORY_BUDGET_HH
@@ -2,6 +2,7 @@
 
 #include "util.hh"
 
+#include <cerrno>
 #include <cstddef>
 #include <stdexcept>
 #include <unistd.h>
@@ -85,6 +86,8 @@ void Socket::shutdown(const int how) {
 }
 
 //! \note If `mtu` is too small to hold the received datagram, this method throws a std::runtime_error
+//! \details On a non-blocking socket with nothing queued, the payload comes back empty
+//! and the read isn't counted in read_count().
 void UDPSocket::recv(received_datagram &datagram, const size_t mtu) {
     // receive source address and payload
     Address::Raw datagram_source_address;
@@ -95,7 +98,13 @@ void UDPSocket::recv(received_datagram &datagram, const size_t mtu) {
     const ssize_t recv_len = SystemCall(
         "recvfrom",
         ::recvfrom(
-            fd_num(), datagram.payload.data(), datagram.payload.size(), MSG_TRUNC, datagram_source_address, &fromlen));
+            fd_num(), datagram.payload.data(), datagram.payload.size(), MSG_TRUNC, datagram_source_address, &fromlen),
+        EAGAIN);
+
+    if (recv_len < 0) {
+        datagram.payload.clear();
+        return;
+    }
 
     if (recv_len > ssize_t(mtu)) {
         throw runtime_error("recvfrom (oversized datagram)");
@@ -124,7 +133,11 @@ void sendmsg_helper(const int fd_num,
     message.msg_iov = iovecs.data();
     message.msg_iovlen = iovecs.size();
 
-    const ssize_t bytes_sent = SystemCall("sendmsg", ::sendmsg(fd_num, &message, 0));
+    // a non-blocking socket whose send buffer is full drops the datagram, as a congested link would
+    const ssize_t bytes_sent = SystemCall("sendmsg", ::sendmsg(fd_num, &message, 0), EAGAIN);
+    if (bytes_sent < 0) {
+        return;
+    }
 
     if (size_t(bytes_sent) != payload.size()) {
         throw runtime_error("datagram payload too big for sendmsg()");
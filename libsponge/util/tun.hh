@@ -3,13 +3,20 @@
 
 #include "file_descriptor.hh"
 
+#include <cstddef>
 #include <string>
 
 //! A FileDescriptor to a [Linux TUN/TAP](https://www.kernel.org/doc/Documentation/networking/tuntap.txt) device
 class TunTapFD : public FileDescriptor {
+  private:
+    std::string _devname;  //!< the name of the device
+
   public:
     //! Open an existing persistent [TUN or TAP device](https://www.kernel.org/doc/Documentation/networking/tuntap.txt).
     explicit TunTapFD(const std::string &devname, const bool is_tun);
+
+    //! \brief The device's MTU: the largest IP datagram it carries
+    size_t mtu() const;
 };
 
 //! A FileDescriptor to a [Linux TUN](https://www.kernel.org/doc/Documentation/networking/tuntap.txt) device
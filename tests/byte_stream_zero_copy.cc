@@ -0,0 +1,140 @@
+#include "byte_stream.hh"
+#include "file_descriptor.hh"
+#include "memory_budget.hh"
+#include "test_err_if.hh"
+#include "test_should_be.hh"
+#include "util.hh"
+
+#include <array>
+#include <exception>
+#include <iostream>
+#include <unistd.h>
+
+using namespace std;
+
+int main() {
+    try {
+        {
+            ByteStream stream{15};
+            Buffer hello{string("hello")};
+            const char *storage = hello.str().data();
+
+            test_should_be(stream.write(hello), size_t(5));
+            test_should_be(stream.write(string("world")), size_t(5));
+            test_should_be(stream.write(Buffer{string("!!!!!!!!")}), size_t(5));
+            test_should_be(stream.remaining_capacity(), size_t(0));
+            test_should_be(stream.buffer_size(), size_t(15));
+
+            const auto iovecs = stream.peek(7).as_iovecs();
+            test_should_be(iovecs.size(), size_t(2));
+            test_err_if(iovecs.at(0).iov_base != storage, "peek() should not copy a written Buffer");
+            test_should_be(iovecs.at(0).iov_len, size_t(5));
+            test_should_be(iovecs.at(1).iov_len, size_t(2));
+            test_should_be(stream.peek(100).size(), size_t(15));
+
+            test_err_if(stream.peek_output(12) != "helloworld!!", "peek_output() across Buffers");
+            stream.pop_output(7);
+            test_err_if(stream.peek_output(100) != "rld!!!!!", "peek_output() after a partial pop");
+            test_should_be(stream.peek(3).size(), size_t(3));
+            const void *tail = stream.peek(3).as_iovecs().at(0).iov_base;
+            const Buffer sliced = stream.read_buffer(2);
+            test_err_if(sliced.str().data() != tail, "read_buffer() should not copy bytes in one stored Buffer");
+            test_err_if(sliced.copy() != "rl", "read_buffer() within a Buffer");
+            test_err_if(stream.read_buffer(3).copy() != "d!!", "read_buffer() across Buffers");
+            test_err_if(stream.read(8) != "!!!", "read() after read_buffer()");
+            test_should_be(stream.bytes_read(), size_t(15));
+            test_err_if(not stream.buffer_empty(), "stream should be empty");
+        }
+
+        {
+            ByteStream stream{100};
+            test_should_be(stream.write(string(90, 'a')), size_t(90));
+            stream.pop_output(80);
+
+            // the first span is the tail of the current chunk, the second a fresh chunk
+            const auto spans = stream.writable_spans(150);
+            test_should_be(spans.size(), size_t(2));
+            test_should_be(spans.at(0).iov_len + spans.at(1).iov_len, size_t(90));
+            test_should_be(spans.at(0).iov_len, size_t(10));
+            string expected{};
+            for (const auto &span : spans) {
+                const string fill(span.iov_len, char('b' + expected.size() % 7));
+                fill.copy(static_cast<char *>(span.iov_base), fill.size());
+                expected += fill;
+            }
+            test_should_be(stream.buffer_size(), size_t(10));
+            stream.commit(60);
+            test_should_be(stream.buffer_size(), size_t(70));
+            test_should_be(stream.bytes_written(), size_t(150));
+            test_err_if(stream.peek_output(70) != string(10, 'a') + expected.substr(0, 60),
+                        "bytes placed through writable_spans()");
+
+            bool threw = false;
+            try {
+                stream.commit(1);
+            } catch (const runtime_error &) {
+                threw = true;
+            }
+            test_err_if(not threw, "commit() without writable_spans() should throw");
+
+            test_should_be(stream.write(string("xyz")), size_t(3));
+            test_err_if(stream.read(73) != string(10, 'a') + expected.substr(0, 60) + "xyz", "write() after commit()");
+        }
+
+        {
+            // bytes move between a pipe and the stream without an intermediate string
+            array<int, 2> fds{};
+            SystemCall("pipe", ::pipe(fds.data()));
+            FileDescriptor read_end{fds[0]}, write_end{fds[1]};
+
+            ByteStream stream{100};
+            test_should_be(stream.write(string(90, 'a')), size_t(90));
+            stream.pop_output(80);
+            write_end.write(string("0123456789abcdefghij"));
+            // the read is scattered across the tail of the first chunk and a fresh one
+            test_should_be(stream.read_from(read_end, 15), size_t(15));
+            test_should_be(stream.buffer_size(), size_t(25));
+            test_err_if(stream.peek_output(100) != string(10, 'a') + "0123456789abcde", "read_from()");
+
+            test_should_be(stream.write_to(write_end, 22), size_t(22));
+            test_should_be(stream.buffer_size(), size_t(3));
+            test_err_if(read_end.read(100) != "fghij" + string(10, 'a') + "0123456789ab", "write_to()");
+
+            write_end.close();
+            test_should_be(stream.read_from(read_end, 100), size_t(0));
+            test_err_if(not read_end.eof(), "read_from() should notice EOF");
+            test_err_if(stream.read(100) != "cde", "bytes left after write_to()");
+        }
+
+        {
+            // committing nothing is harmless, and an empty stream keeps no chunks for it
+            const size_t baseline = MemoryBudget::global().in_use();
+            ByteStream stream{1000};
+            stream.commit(0);
+
+            array<int, 2> fds{};
+            SystemCall("pipe", ::pipe(fds.data()));
+            FileDescriptor read_end{fds[0]}, write_end{fds[1]};
+            write_end.close();
+            test_should_be(stream.read_from(read_end, 1000), size_t(0));
+            test_should_be(MemoryBudget::global().in_use(), baseline);
+            test_should_be(stream.peek(10).as_iovecs().size(), size_t(0));
+
+            test_should_be(stream.write(string("abc")), size_t(3));
+            test_err_if(stream.read(3) != "abc", "write() after an empty commit()");
+        }
+
+        {
+            ByteStream stream{4};
+            stream.end_input();
+            test_should_be(stream.write(Buffer{string("late")}), size_t(0));
+            test_err_if(not stream.error(), "writing after end_input() should set the error flag");
+            test_err_if(not stream.eof(), "stream should be at EOF");
+        }
+    } catch (const exception &e) {
+        cerr << "Exception: " << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
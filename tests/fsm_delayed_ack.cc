@@ -0,0 +1,104 @@
+#include "tcp_config.hh"
+#include "tcp_expectation.hh"
+#include "tcp_fsm_test_harness.hh"
+#include "tcp_header.hh"
+#include "tcp_segment.hh"
+
+#include <cstdint>
+#include <exception>
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+int main() {
+    try {
+        TCPConfig cfg{};
+        cfg.delayed_ack = true;
+        const WrappingInt32 isn{0};
+        const string d(4000, 'x');
+
+        // test #1: every second segment is ACKed at once, and a lone one when the delay runs out
+        {
+            TCPTestHarness test_1 = TCPTestHarness::in_established(cfg, isn, isn);
+            test_1.send_data(isn + 1, isn + 1, d.cbegin(), d.cbegin() + 1000);
+            test_1.execute(ExpectNoSegment{}, "test 1 failed: the first segment should not be ACKed at once");
+            test_1.send_data(isn + 1001, isn + 1, d.cbegin(), d.cbegin() + 1000);
+            test_1.execute(ExpectOneSegment{}.with_ackno(isn + 2001),
+                           "test 1 failed: the second segment should be ACKed at once");
+
+            test_1.send_data(isn + 2001, isn + 1, d.cbegin(), d.cbegin() + 1000);
+            test_1.execute(Tick(cfg.ack_delay - 1));
+            test_1.execute(ExpectNoSegment{}, "test 1 failed: the ACK should wait for the delay");
+            test_1.execute(Tick(1));
+            test_1.execute(ExpectOneSegment{}.with_ackno(isn + 3001), "test 1 failed: the delayed ACK is due");
+        }
+
+        // test #2: out-of-order data, the segment that fills the hole and a FIN are ACKed at once
+        {
+            TCPTestHarness test_2 = TCPTestHarness::in_established(cfg, isn, isn);
+            test_2.send_data(isn + 1001, isn + 1, d.cbegin(), d.cbegin() + 1000);
+            test_2.execute(ExpectOneSegment{}.with_ackno(isn + 1), "test 2 failed: out-of-order data needs an ACK");
+            test_2.send_data(isn + 1, isn + 1, d.cbegin(), d.cbegin() + 1000);
+            test_2.execute(ExpectOneSegment{}.with_ackno(isn + 2001),
+                           "test 2 failed: the segment that fills a hole needs an ACK");
+            test_2.send_fin(isn + 2001, isn + 1);
+            test_2.execute(ExpectOneSegment{}.with_ackno(isn + 2002), "test 2 failed: a FIN needs an ACK");
+        }
+
+        // test #3: outgoing data carries the delayed ACK
+        {
+            TCPTestHarness test_3 = TCPTestHarness::in_established(cfg, isn, isn);
+            test_3.send_data(isn + 1, isn + 1, d.cbegin(), d.cbegin() + 1000);
+            test_3.execute(ExpectNoSegment{});
+            test_3.execute(Write{"hello"});
+            test_3.execute(ExpectOneSegment{}.with_ackno(isn + 1001).with_data("hello"),
+                           "test 3 failed: the data should carry the ACK");
+            test_3.execute(Tick(cfg.ack_delay));
+            test_3.execute(ExpectNoSegment{}, "test 3 failed: the ACK was already sent");
+        }
+
+        // test #4: a window that opens by a full segment is advertised without waiting
+        {
+            TCPConfig small_window = cfg;
+            small_window.recv_capacity = 2000;
+            TCPTestHarness test_4 = TCPTestHarness::in_established(small_window, isn, isn);
+            test_4.send_data(isn + 1, isn + 1, d.cbegin(), d.cbegin() + 1000);
+            test_4.execute(ExpectNoSegment{});
+            test_4.execute(ExpectData{}.with_data(d.substr(0, 1000)));
+            test_4.execute(Tick(1));
+            test_4.execute(ExpectOneSegment{}.with_ackno(isn + 1001).with_win(2000),
+                           "test 4 failed: the window update should go out at once");
+        }
+
+        // test #5: without delayed ACKs, every segment is ACKed
+        {
+            TCPTestHarness test_5 = TCPTestHarness::in_established(TCPConfig{}, isn, isn);
+            test_5.send_data(isn + 1, isn + 1, d.cbegin(), d.cbegin() + 1000);
+            test_5.execute(ExpectOneSegment{}.with_ackno(isn + 1001), "test 5 failed: ACKs should not be delayed");
+        }
+
+        // test #6: data sent in reply to the peer's data and ACK carries the ACK, so no pure ACK follows it
+        {
+            TCPTestHarness test_6 = TCPTestHarness::in_established(cfg, isn, isn);
+            test_6.execute(Write{d.substr(0, 300)});
+            test_6.execute(Tick(1));
+            test_6.execute(ExpectOneSegment{}.with_seqno(isn + 1).with_payload_size(137));
+            test_6.execute(SendSegment{}
+                               .with_ack(true)
+                               .with_seqno(isn + 1)
+                               .with_ackno(isn + 138)
+                               .with_win(137)
+                               .with_data(d.substr(0, 100)));
+            test_6.execute(ExpectOneSegment{}.with_seqno(isn + 138).with_ackno(isn + 101).with_payload_size(137),
+                           "test 6 failed: the newly allowed data should carry the ACK");
+            test_6.execute(Tick(cfg.ack_delay));
+            test_6.execute(ExpectNoSegment{}, "test 6 failed: the ACK already went out with the data");
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return 1;
+    }
+
+    return EXIT_SUCCESS;
+}
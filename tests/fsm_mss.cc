@@ -0,0 +1,135 @@
+#include "tcp_config.hh"
+#include "tcp_expectation.hh"
+#include "tcp_fsm_test_harness.hh"
+#include "tcp_header.hh"
+#include "tcp_segment.hh"
+
+#include <cstdint>
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+using State = TCPTestHarness::State;
+
+int main() {
+    try {
+        TCPConfig cfg{};
+        const string d(1200, 'x');
+
+        // test #1: the peer's smaller MSS sets the segment size, and ours goes on the SYN/ACK
+        {
+            TCPTestHarness test_1(cfg);
+            test_1.execute(Listen{});
+            test_1.execute(SendSegment{}.with_syn(true).with_seqno(0).with_win(5000).with_mss(500));
+            test_1.execute(Tick(1));
+            TCPSegment seg = test_1.expect_seg(ExpectOneSegment{}.with_syn(true).with_ackno(1).with_mss(cfg.mss),
+                                               "test 1 failed: SYN/ACK should carry our MSS");
+            const WrappingInt32 isn = seg.header().seqno;
+            test_1.send_ack(WrappingInt32{1}, isn + 1, 5000);
+            test_1.execute(ExpectState{State::ESTABLISHED});
+
+            test_1.execute(Write{d});
+            test_1.execute(Tick(1));
+            test_1.execute(ExpectSegment{}.with_seqno(isn + 1).with_payload_size(500),
+                           "test 1 failed: segments should fit the peer's MSS");
+            test_1.execute(ExpectSegment{}.with_seqno(isn + 501).with_payload_size(500));
+            test_1.execute(ExpectOneSegment{}.with_seqno(isn + 1001).with_payload_size(200));
+        }
+
+        // test #2: without an MSS option from the peer, the configured one is used
+        {
+            TCPTestHarness test_2(cfg);
+            test_2.execute(Listen{});
+            test_2.execute(SendSegment{}.with_syn(true).with_seqno(0).with_win(5000));
+            test_2.execute(Tick(1));
+            TCPSegment seg = test_2.expect_seg(ExpectOneSegment{}.with_syn(true).with_ackno(1),
+                                               "test 2 failed: no SYN/ACK");
+            const WrappingInt32 isn = seg.header().seqno;
+            test_2.send_ack(WrappingInt32{1}, isn + 1, 5000);
+
+            test_2.execute(Write{d});
+            test_2.execute(Tick(1));
+            test_2.execute(ExpectSegment{}.with_seqno(isn + 1).with_payload_size(cfg.mss),
+                           "test 2 failed: segments should be of the configured MSS");
+            test_2.execute(ExpectOneSegment{}.with_payload_size(d.size() - cfg.mss));
+        }
+
+        // test #3: an active opener sends its MSS, and a larger one from the peer doesn't raise it
+        {
+            TCPConfig small_mss{};
+            small_mss.mss = 600;
+            TCPTestHarness test_3(small_mss);
+            test_3.execute(Connect{});
+            TCPSegment seg = test_3.expect_seg(ExpectOneSegment{}.with_syn(true).with_mss(600),
+                                               "test 3 failed: SYN should carry the configured MSS");
+            const WrappingInt32 isn = seg.header().seqno;
+            test_3.execute(SendSegment{}.with_syn(true).with_ack(true).with_seqno(0).with_ackno(isn + 1).with_win(5000)
+                               .with_mss(1400));
+            test_3.execute(ExpectOneSegment{}.with_ackno(1).with_payload_size(0));
+            test_3.execute(ExpectState{State::ESTABLISHED});
+
+            test_3.execute(Write{d});
+            test_3.execute(Tick(1));
+            test_3.execute(ExpectSegment{}.with_seqno(isn + 1).with_payload_size(600),
+                           "test 3 failed: the peer's larger MSS should not raise ours");
+            test_3.execute(ExpectOneSegment{}.with_seqno(isn + 601).with_payload_size(600));
+        }
+
+        // test #4: timestamps and SACK blocks come out of the MSS, so no segment outgrows MSS + 40 bytes of headers
+        {
+            TCPConfig options{};
+            options.sack = true;
+            options.timestamps = true;
+            TCPTestHarness test_4(options);
+            test_4.execute(Listen{});
+            test_4.execute(SendSegment{}
+                               .with_syn(true)
+                               .with_seqno(0)
+                               .with_win(5000)
+                               .with_mss(500)
+                               .with_sack_permitted(true)
+                               .with_timestamp(100, 0));
+            test_4.execute(Tick(1));
+            TCPSegment seg = test_4.expect_seg(ExpectOneSegment{}.with_syn(true).with_ackno(1),
+                                               "test 4 failed: no SYN/ACK");
+            const WrappingInt32 isn = seg.header().seqno;
+            const uint32_t tsval = seg.header().timestamp->value;
+            test_4.execute(SendSegment{}.with_ack(true).with_seqno(1).with_ackno(isn + 1).with_win(5000).with_timestamp(
+                101, tsval));
+            test_4.execute(ExpectState{State::ESTABLISHED});
+
+            // three holes, so our ACKs carry three SACK blocks
+            for (uint32_t i = 0; i < 3; i++) {
+                test_4.execute(SendSegment{}
+                                   .with_ack(true)
+                                   .with_seqno(11 + 10 * i)
+                                   .with_ackno(isn + 1)
+                                   .with_win(5000)
+                                   .with_timestamp(102 + i, tsval)
+                                   .with_data("abcde"));
+                test_4.execute(ExpectOneSegment{}.with_ackno(1), "test 4 failed: out-of-order data should be ACKed");
+            }
+
+            test_4.execute(Write{d});
+            test_4.execute(Tick(1));
+            size_t sent = 0;
+            while (sent < d.size()) {
+                seg = test_4.expect_seg(ExpectSegment{}.with_seqno(isn + 1 + sent), "test 4 failed: missing data");
+                const size_t header = seg.header().serialize().size();
+                if (header + seg.payload().size() > 500 + 2 * TCPHeader::LENGTH) {
+                    throw runtime_error("test 4 failed: a " + to_string(seg.payload().size()) + "-byte segment with " +
+                                        to_string(header) + " bytes of TCP header outgrows the MSS");
+                }
+                sent += seg.payload().size();
+            }
+            test_4.execute(ExpectNoSegment{});
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return 1;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,95 @@
+#include "tcp_config.hh"
+#include "tcp_expectation.hh"
+#include "tcp_fsm_test_harness.hh"
+#include "tcp_header.hh"
+#include "tcp_segment.hh"
+
+#include <cstdint>
+#include <exception>
+#include <iostream>
+#include <string>
+
+using namespace std;
+using State = TCPTestHarness::State;
+
+int main() {
+    try {
+        TCPConfig cfg{};
+        cfg.sack = true;
+        const string d = "0123456789abcdefghijklmnopqrstuvwxyz";
+
+        // test #1: both SYNs offer SACK, so out-of-order data is SACKed
+        {
+            TCPTestHarness test_1(cfg);
+            test_1.execute(Listen{});
+            test_1.execute(SendSegment{}.with_syn(true).with_seqno(0).with_sack_permitted(true));
+            test_1.execute(Tick(1));
+            TCPSegment seg =
+                test_1.expect_seg(ExpectOneSegment{}.with_syn(true).with_ackno(1).with_sack_permitted(true),
+                                  "test 1 failed: SYN/ACK should accept SACK");
+            const WrappingInt32 ackno = seg.header().seqno + 1;
+            test_1.send_ack(WrappingInt32{1}, ackno);
+            test_1.execute(ExpectState{State::ESTABLISHED});
+
+            test_1.send_data(WrappingInt32{11}, ackno, d.cbegin() + 10, d.cbegin() + 15);
+            test_1.execute(ExpectOneSegment{}.with_ackno(1).with_sack({{WrappingInt32{11}, WrappingInt32{16}}}),
+                           "test 1 failed: wrong SACK for one hole");
+
+            // the block with the newest data comes first
+            test_1.send_data(WrappingInt32{21}, ackno, d.cbegin() + 20, d.cbegin() + 23);
+            test_1.execute(ExpectOneSegment{}.with_ackno(1).with_sack(
+                               {{WrappingInt32{21}, WrappingInt32{24}}, {WrappingInt32{11}, WrappingInt32{16}}}),
+                           "test 1 failed: wrong SACK for two holes");
+
+            // adjacent data merges into its block
+            test_1.send_data(WrappingInt32{16}, ackno, d.cbegin() + 15, d.cbegin() + 18);
+            test_1.execute(ExpectOneSegment{}.with_ackno(1).with_sack(
+                               {{WrappingInt32{11}, WrappingInt32{19}}, {WrappingInt32{21}, WrappingInt32{24}}}),
+                           "test 1 failed: wrong SACK after filling part of a hole");
+
+            test_1.send_data(WrappingInt32{1}, ackno, d.cbegin(), d.cbegin() + 10);
+            test_1.execute(ExpectOneSegment{}.with_ackno(19).with_sack({{WrappingInt32{21}, WrappingInt32{24}}}),
+                           "test 1 failed: wrong SACK after filling the first hole");
+
+            test_1.send_data(WrappingInt32{19}, ackno, d.cbegin() + 18, d.cbegin() + 20);
+            test_1.execute(ExpectOneSegment{}.with_ackno(24).with_sack({}),
+                           "test 1 failed: no SACK expected without holes");
+            test_1.execute(ExpectData{}.with_data(d.substr(0, 23)));
+        }
+
+        // test #2: the peer doesn't offer SACK, so none is sent
+        {
+            TCPTestHarness test_2(cfg);
+            test_2.execute(Listen{});
+            test_2.send_syn(WrappingInt32{0});
+            test_2.execute(Tick(1));
+            TCPSegment seg = test_2.expect_seg(ExpectOneSegment{}.with_syn(true).with_sack_permitted(false),
+                                               "test 2 failed: SYN/ACK should not offer SACK");
+            const WrappingInt32 ackno = seg.header().seqno + 1;
+            test_2.send_ack(WrappingInt32{1}, ackno);
+
+            test_2.send_data(WrappingInt32{11}, ackno, d.cbegin() + 10, d.cbegin() + 15);
+            test_2.execute(ExpectOneSegment{}.with_ackno(1).with_sack({}), "test 2 failed: unexpected SACK");
+        }
+
+        // test #3: an active opener offers SACK unless configured not to
+        {
+            TCPTestHarness test_3(cfg);
+            test_3.execute(Connect{});
+            test_3.execute(ExpectOneSegment{}.with_syn(true).with_sack_permitted(true),
+                           "test 3 failed: SYN should offer SACK");
+
+            TCPConfig no_sack{};
+            no_sack.sack = false;
+            TCPTestHarness test_4(no_sack);
+            test_4.execute(Connect{});
+            test_4.execute(ExpectOneSegment{}.with_syn(true).with_sack_permitted(false),
+                           "test 3 failed: SYN should not offer SACK");
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return 1;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,61 @@
+#include "byte_stream.hh"
+#include "fsm_stream_reassembler_harness.hh"
+#include "stream_reassembler.hh"
+#include "util.hh"
+
+#include <exception>
+#include <iostream>
+
+using namespace std;
+
+int main() {
+    try {
+        {
+            ReassemblerTestHarness test{65000};
+
+            test.execute(SubmitSegment{"abcd", 0});
+            test.execute(SubmitSegment{"cdefgh", 2});
+            test.execute(BytesAssembled(8));
+            test.execute(UnassembledBytes(0));
+            test.execute(PathsTaken(2, 0));
+            test.execute(BytesAvailable("abcdefgh"));
+        }
+
+        {
+            ReassemblerTestHarness test{65000};
+
+            test.execute(SubmitSegment{"efgh", 4});
+            test.execute(PathsTaken(0, 1));
+            test.execute(SubmitSegment{"abcd", 0});
+            test.execute(PathsTaken(0, 2));
+            test.execute(BytesAssembled(8));
+
+            // nothing is stored any more, so in-order data is fast again
+            test.execute(SubmitSegment{"ijkl", 8}.with_eof(true));
+            test.execute(PathsTaken(1, 2));
+            test.execute(BytesAvailable("abcdefghijkl"));
+            test.execute(AtEof{});
+        }
+
+        {
+            // in order, but more than the output stream can take
+            ReassemblerTestHarness test{4};
+
+            test.execute(SubmitSegment{"ab", 0});
+            test.execute(SubmitSegment{"cdef", 2});
+            test.execute(PathsTaken(1, 1));
+            test.execute(BytesAssembled(4));
+            test.execute(UnassembledBytes(2));
+            test.execute(BytesAvailable("abcd"));
+
+            test.execute(SubmitSegment{"", 6});
+            test.execute(PathsTaken(1, 2));
+            test.execute(BytesAvailable("ef"));
+        }
+    } catch (const exception &e) {
+        cerr << "Exception: " << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -103,6 +103,29 @@ struct UnassembledBytes : public ReassemblerExpectation {
     }
 };
 
+struct PathsTaken : public ReassemblerExpectation {
+    uint64_t _fast_path;
+    uint64_t _slow_path;
+
+    PathsTaken(uint64_t fast_path, uint64_t slow_path) : _fast_path(fast_path), _slow_path(slow_path) {}
+    std::string description() const {
+        std::ostringstream ss;
+        ss << "fast path taken " << _fast_path << " times, slow path " << _slow_path << " times";
+        return ss.str();
+    }
+
+    void execute(StreamReassembler &reassembler) const {
+        const auto &stats = reassembler.stats();
+        if (stats.fast_path != _fast_path or stats.slow_path != _slow_path) {
+            std::ostringstream ss;
+            ss << "The reassembler was expected to take the fast path `" << _fast_path << "` times and the slow path `"
+               << _slow_path << "` times, but took them `" << stats.fast_path << "` and `" << stats.slow_path
+               << "` times";
+            throw ReassemblerExpectationViolation(ss.str());
+        }
+    }
+};
+
 struct AtEof : public ReassemblerExpectation {
     AtEof() {}
     std::string description() const {
@@ -0,0 +1,160 @@
+#include "tcp_config.hh"
+#include "tcp_expectation.hh"
+#include "tcp_fsm_test_harness.hh"
+#include "tcp_header.hh"
+#include "tcp_segment.hh"
+
+#include <cstdint>
+#include <exception>
+#include <iostream>
+#include <string>
+
+using namespace std;
+using State = TCPTestHarness::State;
+
+int main() {
+    try {
+        TCPConfig cfg{};
+        cfg.timestamps = true;
+        const string d = "abcdefgh";
+
+        // test #1: every segment carries a timestamp and echoes the peer's, and PAWS drops old duplicates
+        {
+            TCPTestHarness test_1(cfg);
+            test_1.execute(Listen{});
+            test_1.execute(SendSegment{}.with_syn(true).with_seqno(0).with_win(5000).with_timestamp(100, 0));
+            test_1.execute(Tick(1));
+            TCPSegment seg = test_1.expect_seg(ExpectOneSegment{}.with_syn(true).with_ackno(1).with_timestamp_echo(100),
+                                               "test 1 failed: SYN/ACK should echo the peer's timestamp");
+            const WrappingInt32 isn = seg.header().seqno;
+            const uint32_t tsval = seg.header().timestamp->value;
+            test_1.execute(SendSegment{}.with_ack(true).with_seqno(1).with_ackno(isn + 1).with_win(5000).with_timestamp(
+                110, tsval));
+            test_1.execute(ExpectState{State::ESTABLISHED});
+
+            test_1.execute(SendSegment{}
+                               .with_ack(true)
+                               .with_seqno(1)
+                               .with_ackno(isn + 1)
+                               .with_win(5000)
+                               .with_timestamp(120, tsval)
+                               .with_data(d.substr(0, 4)));
+            test_1.execute(ExpectOneSegment{}.with_ackno(5).with_timestamp_echo(120),
+                           "test 1 failed: the ACK should echo the latest timestamp");
+            test_1.execute(ExpectData{}.with_data(d.substr(0, 4)));
+
+            // an old duplicate (its timestamp went backwards) is ACKed but not delivered
+            test_1.execute(SendSegment{}
+                               .with_ack(true)
+                               .with_seqno(5)
+                               .with_ackno(isn + 1)
+                               .with_win(5000)
+                               .with_timestamp(90, tsval)
+                               .with_data(d.substr(4, 4)));
+            test_1.execute(ExpectOneSegment{}.with_ackno(5).with_timestamp_echo(120),
+                           "test 1 failed: PAWS should reject an old timestamp");
+            test_1.execute(ExpectNoData{});
+
+            test_1.execute(SendSegment{}
+                               .with_ack(true)
+                               .with_seqno(5)
+                               .with_ackno(isn + 1)
+                               .with_win(5000)
+                               .with_timestamp(130, tsval)
+                               .with_data(d.substr(4, 4)));
+            test_1.execute(ExpectOneSegment{}.with_ackno(9).with_timestamp_echo(130),
+                           "test 1 failed: a newer timestamp should be accepted");
+            test_1.execute(ExpectData{}.with_data(d.substr(4, 4)));
+        }
+
+        // test #2: a segment past a hole doesn't update the timestamp to echo
+        {
+            TCPTestHarness test_2(cfg);
+            test_2.execute(Listen{});
+            test_2.execute(SendSegment{}.with_syn(true).with_seqno(0).with_win(5000).with_timestamp(100, 0));
+            test_2.execute(Tick(1));
+            TCPSegment seg = test_2.expect_seg(ExpectOneSegment{}.with_syn(true).with_ackno(1),
+                                               "test 2 failed: no SYN/ACK");
+            const WrappingInt32 isn = seg.header().seqno;
+            const uint32_t tsval = seg.header().timestamp->value;
+
+            test_2.execute(SendSegment{}
+                               .with_ack(true)
+                               .with_seqno(5)
+                               .with_ackno(isn + 1)
+                               .with_win(5000)
+                               .with_timestamp(120, tsval)
+                               .with_data(d.substr(4, 4)));
+            test_2.execute(ExpectOneSegment{}.with_ackno(1).with_timestamp_echo(100),
+                           "test 2 failed: a segment past the ackno should not be echoed");
+            test_2.execute(SendSegment{}
+                               .with_ack(true)
+                               .with_seqno(1)
+                               .with_ackno(isn + 1)
+                               .with_win(5000)
+                               .with_timestamp(130, tsval)
+                               .with_data(d.substr(0, 4)));
+            test_2.execute(ExpectOneSegment{}.with_ackno(9).with_timestamp_echo(130),
+                           "test 2 failed: the segment that filled the hole should be echoed");
+        }
+
+        // test #3: the peer doesn't offer timestamps, so none are sent after the SYN
+        {
+            TCPTestHarness test_3(cfg);
+            test_3.execute(Listen{});
+            test_3.execute(SendSegment{}.with_syn(true).with_seqno(0).with_win(5000));
+            test_3.execute(Tick(1));
+            TCPSegment seg = test_3.expect_seg(ExpectOneSegment{}.with_syn(true).with_ackno(1),
+                                               "test 3 failed: no SYN/ACK");
+            if (seg.header().timestamp.has_value()) {
+                throw runtime_error("test 3 failed: SYN/ACK should not carry a timestamp");
+            }
+            const WrappingInt32 isn = seg.header().seqno;
+            test_3.send_data(WrappingInt32{1}, isn + 1, d.cbegin(), d.cbegin() + 4);
+            seg = test_3.expect_seg(ExpectOneSegment{}.with_ackno(5), "test 3 failed: no ACK");
+            if (seg.header().timestamp.has_value()) {
+                throw runtime_error("test 3 failed: ACK should not carry a timestamp");
+            }
+        }
+
+        // test #4: a delayed ACK echoes the first segment it covers, not the latest (RFC 7323 Last.ACK.sent)
+        {
+            TCPConfig delayed = cfg;
+            delayed.delayed_ack = true;
+            TCPTestHarness test_4(delayed);
+            test_4.execute(Listen{});
+            test_4.execute(SendSegment{}.with_syn(true).with_seqno(0).with_win(5000).with_timestamp(100, 0));
+            test_4.execute(Tick(1));
+            TCPSegment seg = test_4.expect_seg(ExpectOneSegment{}.with_syn(true).with_ackno(1),
+                                               "test 4 failed: no SYN/ACK");
+            const WrappingInt32 isn = seg.header().seqno;
+            const uint32_t tsval = seg.header().timestamp->value;
+            test_4.execute(SendSegment{}.with_ack(true).with_seqno(1).with_ackno(isn + 1).with_win(5000).with_timestamp(
+                110, tsval));
+            test_4.execute(ExpectState{State::ESTABLISHED});
+
+            test_4.execute(SendSegment{}
+                               .with_ack(true)
+                               .with_seqno(1)
+                               .with_ackno(isn + 1)
+                               .with_win(5000)
+                               .with_timestamp(120, tsval)
+                               .with_data(d.substr(0, 4)));
+            test_4.execute(ExpectNoSegment{}, "test 4 failed: the first segment's ACK should be delayed");
+            test_4.execute(SendSegment{}
+                               .with_ack(true)
+                               .with_seqno(5)
+                               .with_ackno(isn + 1)
+                               .with_win(5000)
+                               .with_timestamp(130, tsval)
+                               .with_data(d.substr(4, 4)));
+            test_4.execute(ExpectOneSegment{}.with_ackno(9).with_timestamp_echo(120),
+                           "test 4 failed: the ACK should echo the first segment it covers");
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return 1;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,94 @@
+#include "tcp_config.hh"
+#include "tcp_expectation.hh"
+#include "tcp_fsm_test_harness.hh"
+#include "tcp_header.hh"
+#include "tcp_segment.hh"
+
+#include <cstdint>
+#include <exception>
+#include <iostream>
+#include <string>
+
+using namespace std;
+using State = TCPTestHarness::State;
+
+int main() {
+    try {
+        TCPConfig cfg{};
+        cfg.window_scaling = true;
+        cfg.recv_capacity = 1 << 20;
+        cfg.send_capacity = 1 << 20;
+        const string d(70000, 'x');
+
+        // test #1: with both SYNs offering window scaling, windows past 64 KiB work both ways
+        {
+            TCPTestHarness test_1(cfg);
+            test_1.execute(Listen{});
+            test_1.execute(SendSegment{}.with_syn(true).with_seqno(0).with_win(5000).with_window_scale(2));
+            test_1.execute(Tick(1));
+            // the window on a SYN is never scaled
+            TCPSegment seg =
+                test_1.expect_seg(ExpectOneSegment{}.with_syn(true).with_ackno(1).with_window_scale(5).with_win(65535),
+                                  "test 1 failed: SYN/ACK should offer a window scale of 5 for 1 MiB");
+            const WrappingInt32 isn = seg.header().seqno;
+            test_1.send_ack(WrappingInt32{1}, isn + 1, 20000);
+            test_1.execute(ExpectState{State::ESTABLISHED});
+
+            // the peer's window is 20000 << 2
+            test_1.execute(Write{d});
+            test_1.execute(Tick(1));
+            for (unsigned int i = 0; i < 70; i++) {
+                test_1.execute(ExpectSegment{}.with_seqno(isn + 1 + 1000 * i).with_payload_size(1000),
+                               "test 1 failed: the peer's scaled window should be used");
+            }
+            test_1.execute(ExpectNoSegment{}, "test 1 failed: nothing left to send");
+
+            test_1.send_data(WrappingInt32{1}, isn + 1, d.cbegin(), d.cbegin() + 10);
+            test_1.execute(ExpectOneSegment{}.with_ackno(11).with_win(((1 << 20) - 10) >> 5),
+                           "test 1 failed: our window should be scaled down by 5");
+        }
+
+        // test #2: the peer doesn't offer window scaling, so windows stay below 64 KiB
+        {
+            TCPTestHarness test_2(cfg);
+            test_2.execute(Listen{});
+            test_2.execute(SendSegment{}.with_syn(true).with_seqno(0).with_win(5000));
+            test_2.execute(Tick(1));
+            TCPSegment seg = test_2.expect_seg(ExpectOneSegment{}.with_syn(true).with_ackno(1).with_win(65535),
+                                               "test 2 failed: no SYN/ACK");
+            if (seg.header().window_scale.has_value()) {
+                throw runtime_error("test 2 failed: SYN/ACK should not offer window scaling");
+            }
+            const WrappingInt32 isn = seg.header().seqno;
+            test_2.send_ack(WrappingInt32{1}, isn + 1, 1000);
+
+            test_2.execute(Write{d});
+            test_2.execute(Tick(1));
+            test_2.execute(ExpectOneSegment{}.with_seqno(isn + 1).with_payload_size(1000),
+                           "test 2 failed: the peer's window should not be scaled");
+
+            test_2.send_data(WrappingInt32{1}, isn + 1, d.cbegin(), d.cbegin() + 10);
+            test_2.execute(ExpectOneSegment{}.with_ackno(11).with_win(65535),
+                           "test 2 failed: our window should be capped at 64 KiB");
+        }
+
+        // test #3: an active opener offers window scaling, and scales once the SYN/ACK agrees
+        {
+            TCPTestHarness test_3(cfg);
+            test_3.execute(Connect{});
+            TCPSegment seg = test_3.expect_seg(ExpectOneSegment{}.with_syn(true).with_window_scale(5),
+                                               "test 3 failed: SYN should offer window scaling");
+            const WrappingInt32 isn = seg.header().seqno;
+            test_3.execute(
+                SendSegment{}.with_syn(true).with_ack(true).with_seqno(0).with_ackno(isn + 1).with_window_scale(0));
+            test_3.execute(ExpectOneSegment{}.with_ackno(1).with_win((1 << 20) >> 5),
+                           "test 3 failed: the ACK of the SYN/ACK should have a scaled window");
+            test_3.execute(ExpectState{State::ESTABLISHED});
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return 1;
+    }
+
+    return EXIT_SUCCESS;
+}
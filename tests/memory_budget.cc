@@ -0,0 +1,137 @@
+#include "byte_stream.hh"
+#include "memory_budget.hh"
+#include "stream_reassembler.hh"
+#include "tcp_receiver.hh"
+#include "test_err_if.hh"
+#include "test_should_be.hh"
+
+#include <exception>
+#include <iostream>
+#include <limits>
+
+using namespace std;
+
+int main() {
+    try {
+        {
+            MemoryBudget budget{1000, 400};
+            test_should_be(budget.window(5000), size_t(1000));
+
+            auto chunk = budget.make_chunk(600);
+            test_should_be(budget.in_use(), size_t(600));
+            test_should_be(budget.window(5000), size_t(400));
+            test_should_be(budget.window(100), size_t(100));
+
+            // a Buffer keeps the storage (and the charge) alive after the chunk pointer is gone
+            Buffer slice{chunk, 0, 10};
+            chunk.reset();
+            test_should_be(budget.in_use(), size_t(600));
+
+            budget.charge(500);
+            test_err_if(not budget.under_pressure(), "crossing the high watermark should start the pressure");
+            test_should_be(budget.window(5000), size_t(0));
+
+            budget.release(500);
+            test_err_if(not budget.under_pressure(), "the pressure should last until the low watermark");
+            test_should_be(budget.window(5000), size_t(0));
+
+            slice = Buffer{};
+            test_should_be(budget.in_use(), size_t(0));
+            test_err_if(budget.under_pressure(), "dropping below the low watermark should end the pressure");
+            test_should_be(budget.window(5000), size_t(1000));
+
+            bool threw = false;
+            try {
+                budget.set_watermarks(10, 20);
+            } catch (const runtime_error &) {
+                threw = true;
+            }
+            test_err_if(not threw, "a low watermark above the high one should throw");
+        }
+
+        {
+            MemoryBudget &budget = MemoryBudget::global();
+            const size_t baseline = budget.in_use();
+
+            // nothing is allocated up front
+            ByteStream stream{1 << 20};
+            test_should_be(budget.in_use(), baseline);
+
+            // chunks grow while the stream fills...
+            test_should_be(stream.write(string(100, 'x')), size_t(100));
+            test_should_be(budget.in_use(), baseline + 4096);
+            test_should_be(stream.write(string(10000, 'x')), size_t(10000));
+            test_should_be(budget.in_use(), baseline + 4096 + 8192);
+
+            // ...a full chunk goes away once its bytes are read, and the rest once the stream drains
+            stream.pop_output(10050);
+            test_should_be(budget.in_use(), baseline + 8192);
+            stream.pop_output(50);
+            test_should_be(budget.in_use(), baseline);
+
+            // the first chunk after a drain is sized for the burst that was drained
+            test_should_be(stream.write(string(100, 'x')), size_t(100));
+            test_should_be(budget.in_use(), baseline + 16384);
+            stream.pop_output(100);
+            test_should_be(budget.in_use(), baseline);
+            test_should_be(stream.write(string(100, 'x')), size_t(100));
+            test_should_be(budget.in_use(), baseline + 4096);
+        }
+
+        {
+            MemoryBudget &budget = MemoryBudget::global();
+            const size_t baseline = budget.in_use();
+
+            // a received slice held out of order pins (and is charged for) its whole datagram
+            StreamReassembler reassembler{1 << 20};
+            Buffer datagram{string(1500, 'x')};
+            datagram.remove_prefix(40);
+            reassembler.push_substring(datagram, 100, false);
+            test_should_be(budget.in_use(), baseline + 1500);
+
+            // once adopted, storage isn't charged again as it moves into the stream
+            reassembler.push_substring(Buffer{string(100, 'y')}, 0, false);
+            test_should_be(budget.in_use(), baseline + 1600);
+            test_should_be(reassembler.stream_out().buffer_size(), size_t(1560));
+            datagram = Buffer{};
+            reassembler.stream_out().pop_output(1000);
+            test_should_be(budget.in_use(), baseline + 1500);
+            reassembler.stream_out().pop_output(560);
+            test_should_be(budget.in_use(), baseline);
+        }
+
+        {
+            MemoryBudget &budget = MemoryBudget::global();
+            const WrappingInt32 isn{1000};
+            TCPReceiver receiver{4000};
+            TCPSegment syn{};
+            syn.header().syn = true;
+            syn.header().seqno = isn;
+            receiver.segment_received(syn);
+            test_should_be(receiver.window_size(), size_t(4000));
+            receiver.window_advertised(isn + 1 + 4000);
+
+            // pressure stops the window growing, but never pulls its right edge back
+            budget.set_watermarks(budget.in_use() + 1000, budget.in_use() + 500);
+            budget.charge(2000);
+            test_should_be(receiver.window_size(), size_t(4000));
+            TCPSegment data{};
+            data.header().seqno = isn + 1;
+            data.payload() = string(1500, 'x');
+            receiver.segment_received(data);
+            test_should_be(receiver.window_size(), size_t(2500));
+            receiver.stream_out().pop_output(1500);
+            test_should_be(receiver.window_size(), size_t(2500));
+
+            // once the pressure is over, the window grows again
+            budget.release(2000);
+            budget.set_watermarks(numeric_limits<size_t>::max(), numeric_limits<size_t>::max());
+            test_should_be(receiver.window_size(), size_t(4000));
+        }
+    } catch (const exception &e) {
+        cerr << "Exception: " << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,120 @@
+#include "congestion_control.hh"
+#include "sender_harness.hh"
+#include "test_err_if.hh"
+#include "wrapping_integers.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+int main() {
+    try {
+        auto rd = get_random_generator();
+
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+            cfg.congestion_control = CongestionControl::newreno;
+
+            TCPSenderTestHarness test{"NewReno limits the sender to its congestion window", cfg};
+            test.execute(ExpectSegment{}.with_no_flags().with_syn(true).with_payload_size(0).with_seqno(isn));
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(60000));
+            test.execute(WriteBytes{string(30000, 'a')});
+            // the initial window is ten segments, even though the receiver allows more
+            for (unsigned int i = 0; i < 10; i++) {
+                test.execute(ExpectSegment{}.with_no_flags().with_payload_size(1000).with_seqno(isn + 1 + 1000 * i));
+            }
+            test.execute(ExpectNoSegment{});
+            test.execute(ExpectBytesInFlight{10000});
+
+            // slow start: each acknowledged segment opens the window by another
+            test.execute(AckReceived{WrappingInt32{isn + 1 + 1000}}.with_win(60000));
+            test.execute(ExpectSegment{}.with_payload_size(1000).with_seqno(isn + 1 + 10000));
+            test.execute(ExpectSegment{}.with_payload_size(1000).with_seqno(isn + 1 + 11000));
+            test.execute(ExpectNoSegment{});
+
+            // a timeout collapses the window to one segment
+            test.execute(Tick{cfg.rt_timeout});
+            test.execute(ExpectSegment{}.with_payload_size(1000).with_seqno(isn + 1 + 1000));
+            test.execute(AckReceived{WrappingInt32{isn + 1 + 12000}}.with_win(60000));
+            test.execute(ExpectSegment{}.with_payload_size(1000).with_seqno(isn + 1 + 12000));
+            test.execute(ExpectSegment{}.with_payload_size(1000).with_seqno(isn + 1 + 13000));
+            test.execute(ExpectSegment{}.with_payload_size(1000).with_seqno(isn + 1 + 14000));
+            test.execute(ExpectNoSegment{});
+        }
+
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+            cfg.congestion_control = CongestionControl::cubic;
+
+            TCPSenderTestHarness test{"The receiver's window still applies under congestion control", cfg};
+            test.execute(ExpectSegment{}.with_no_flags().with_syn(true).with_payload_size(0).with_seqno(isn));
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(1500));
+            test.execute(WriteBytes{string(3000, 'a')});
+            test.execute(ExpectSegment{}.with_payload_size(1000).with_seqno(isn + 1));
+            test.execute(ExpectSegment{}.with_payload_size(500).with_seqno(isn + 1001));
+            test.execute(ExpectNoSegment{});
+        }
+
+        {
+            // CUBIC backs off by a factor of 0.7 and climbs back to the old window after K seconds
+            Cubic cubic{1000};
+            test_err_if(cubic.cwnd() != 10000, "CUBIC should start with ten segments");
+            cubic.on_loss(0, 10000);
+            test_err_if(cubic.cwnd() != 7000, "CUBIC should reduce the window to 0.7 of its size");
+            test_err_if(cubic.ssthresh() != 7000, "CUBIC should lower ssthresh with the window");
+
+            // K = cbrt(3 segments / 0.4) is just under two seconds
+            uint64_t now = 0;
+            for (; now < 1000; now += 10) {
+                cubic.on_ack({now, 100, 7000, 10});
+            }
+            test_err_if(cubic.cwnd() >= 10000, "CUBIC should approach its old window slowly");
+            for (; now < 4000; now += 10) {
+                cubic.on_ack({now, 100, 7000, 10});
+            }
+            test_err_if(cubic.cwnd() <= 10000, "CUBIC should probe past its old window after K");
+
+            cubic.on_timeout(now, 10000);
+            test_err_if(cubic.cwnd() != 1000, "CUBIC should restart from one segment after a timeout");
+        }
+
+        {
+            // BBR learns a steady 100 bytes/ms path with a 50 ms RTT
+            BBR bbr{1000};
+            test_err_if(bbr.pacing_rate().has_value(), "BBR has no pacing rate before its first round");
+            for (uint64_t now = 1; now <= 3000; now++) {
+                bbr.on_ack({now, 100, 5000, 50});
+            }
+            test_err_if(bbr.mode() != BBR::Mode::probe_bw, "BBR should settle in probe_bw");
+            test_err_if(bbr.min_rtt() != 50, "BBR should measure the minimum RTT");
+            test_err_if(bbr.bottleneck_bandwidth() < 99 or bbr.bottleneck_bandwidth() > 101,
+                        "BBR should measure the bottleneck bandwidth");
+            test_err_if(bbr.cwnd() != 10000, "BBR's window should be twice the bandwidth-delay product");
+            test_err_if(not bbr.pacing_rate().has_value(), "BBR should pace once it has a model");
+
+            // loss alone does not shrink BBR's window below what is in flight
+            bbr.on_loss(3000, 8000);
+            test_err_if(bbr.cwnd() != 8000, "BBR should conserve packets on loss");
+        }
+
+        {
+            test_err_if(make_congestion_controller(CongestionControl::none, 1000) != nullptr,
+                        "no controller should be made for CongestionControl::none");
+            test_err_if(make_congestion_controller(CongestionControl::bbr, 1000)->name() != "bbr",
+                        "the factory should make the requested controller");
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return 1;
+    }
+
+    return EXIT_SUCCESS;
+}
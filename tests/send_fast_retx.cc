@@ -0,0 +1,114 @@
+#include "sender_harness.hh"
+#include "wrapping_integers.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+int main() {
+    try {
+        auto rd = get_random_generator();
+
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+            cfg.fast_retransmit = true;
+
+            TCPSenderTestHarness test{"Three duplicate ACKs resend the missing segment", cfg};
+            test.execute(ExpectSegment{}.with_no_flags().with_syn(true).with_payload_size(0).with_seqno(isn));
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(10000));
+            test.execute(WriteBytes{string(5000, 'a')});
+            for (unsigned int i = 0; i < 5; i++) {
+                test.execute(ExpectSegment{}.with_payload_size(1000).with_seqno(isn + 1 + 1000 * i));
+            }
+            test.execute(AckReceived{WrappingInt32{isn + 1001}}.with_win(10000));
+            test.execute(AckReceived{WrappingInt32{isn + 1001}}.with_win(10000));
+            test.execute(AckReceived{WrappingInt32{isn + 1001}}.with_win(10000));
+            test.execute(ExpectNoSegment{});
+            test.execute(AckReceived{WrappingInt32{isn + 1001}}.with_win(10000));
+            test.execute(ExpectSegment{}.with_payload_size(1000).with_seqno(isn + 1001));
+            test.execute(AckReceived{WrappingInt32{isn + 1001}}.with_win(10000));
+            test.execute(ExpectNoSegment{});
+
+            // a partial ACK shows the next hole, which is resent without waiting for more duplicates
+            test.execute(AckReceived{WrappingInt32{isn + 3001}}.with_win(10000));
+            test.execute(ExpectSegment{}.with_payload_size(1000).with_seqno(isn + 3001));
+            test.execute(AckReceived{WrappingInt32{isn + 5001}}.with_win(10000));
+            test.execute(ExpectNoSegment{});
+            test.execute(ExpectBytesInFlight{0});
+        }
+
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+            cfg.fast_retransmit = true;
+
+            TCPSenderTestHarness test{"An ACK that changes the window is not a duplicate", cfg};
+            test.execute(ExpectSegment{}.with_no_flags().with_syn(true).with_payload_size(0).with_seqno(isn));
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(3000));
+            test.execute(WriteBytes{string(2000, 'a')});
+            test.execute(ExpectSegment{}.with_payload_size(1000).with_seqno(isn + 1));
+            test.execute(ExpectSegment{}.with_payload_size(1000).with_seqno(isn + 1001));
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(2000));
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(1000));
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(2000));
+            test.execute(ExpectNoSegment{});
+        }
+
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+            cfg.fast_retransmit = true;
+            cfg.congestion_control = CongestionControl::newreno;
+
+            TCPSenderTestHarness test{"Fast recovery halves the window and sends on further duplicates", cfg};
+            test.execute(ExpectSegment{}.with_no_flags().with_syn(true).with_payload_size(0).with_seqno(isn));
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(60000));
+            test.execute(WriteBytes{string(20000, 'a')});
+            for (unsigned int i = 0; i < 10; i++) {
+                test.execute(ExpectSegment{}.with_payload_size(1000).with_seqno(isn + 1 + 1000 * i));
+            }
+            // slow start brings the window to 11000
+            test.execute(AckReceived{WrappingInt32{isn + 1001}}.with_win(60000));
+            test.execute(ExpectSegment{}.with_payload_size(1000).with_seqno(isn + 10001));
+            test.execute(ExpectSegment{}.with_payload_size(1000).with_seqno(isn + 11001));
+            test.execute(ExpectBytesInFlight{11000});
+
+            // ssthresh is half of the 11000 in flight; the three duplicates inflate the window by 3000
+            for (unsigned int i = 0; i < 3; i++) {
+                test.execute(AckReceived{WrappingInt32{isn + 1001}}.with_win(60000));
+            }
+            test.execute(ExpectSegment{}.with_payload_size(1000).with_seqno(isn + 1001));
+            test.execute(ExpectNoSegment{});
+            test.execute(AckReceived{WrappingInt32{isn + 1001}}.with_win(60000));
+            test.execute(AckReceived{WrappingInt32{isn + 1001}}.with_win(60000));
+            test.execute(ExpectNoSegment{});
+            test.execute(AckReceived{WrappingInt32{isn + 1001}}.with_win(60000));
+            test.execute(ExpectSegment{}.with_payload_size(500).with_seqno(isn + 12001));
+            test.execute(AckReceived{WrappingInt32{isn + 1001}}.with_win(60000));
+            test.execute(ExpectSegment{}.with_payload_size(1000).with_seqno(isn + 12501));
+            test.execute(ExpectNoSegment{});
+
+            // the ACK for everything ends the recovery with the window at ssthresh
+            test.execute(AckReceived{WrappingInt32{isn + 13501}}.with_win(60000));
+            for (unsigned int i = 0; i < 5; i++) {
+                test.execute(ExpectSegment{}.with_payload_size(1000).with_seqno(isn + 13501 + 1000 * i));
+            }
+            test.execute(ExpectSegment{}.with_payload_size(500).with_seqno(isn + 18501));
+            test.execute(ExpectNoSegment{});
+            test.execute(ExpectBytesInFlight{5500});
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return 1;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,82 @@
+#include "sender_harness.hh"
+#include "wrapping_integers.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+int main() {
+    try {
+        auto rd = get_random_generator();
+
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+            cfg.gso = true;
+
+            TCPSenderTestHarness test{"With GSO, the window goes out as one segment", cfg};
+            test.execute(ExpectSegment{}.with_no_flags().with_syn(true).with_payload_size(0).with_seqno(isn));
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(10000));
+            test.execute(WriteBytes{string(5000, 'a')});
+            test.execute(ExpectSegment{}.with_payload_size(5000).with_gso_size(1000).with_seqno(isn + 1));
+            test.execute(ExpectNoSegment{});
+
+            // the peer ACKs some of the wire segments, and the rest is still in flight
+            test.execute(AckReceived{WrappingInt32{isn + 2001}}.with_win(10000));
+            test.execute(ExpectBytesInFlight{3000});
+
+            // a timeout resends one MSS, not the whole segment
+            test.execute(Tick{cfg.rt_timeout});
+            test.execute(ExpectSegment{}.with_payload_size(1000).with_seqno(isn + 2001));
+            test.execute(ExpectNoSegment{});
+            test.execute(AckReceived{WrappingInt32{isn + 5001}}.with_win(10000));
+            test.execute(ExpectBytesInFlight{0});
+
+            // a segment that fits in one MSS isn't marked for splitting
+            test.execute(WriteBytes{"hello"});
+            test.execute(ExpectSegment{}.with_data("hello").with_gso_size(0));
+        }
+
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+            cfg.gso = true;
+            cfg.fast_retransmit = true;
+            const auto block = [&](uint32_t left, uint32_t right) {
+                return TCPHeader::SACKBlock{isn + left, isn + right};
+            };
+
+            TCPSenderTestHarness test{"With GSO, SACK recovery resends only the lost wire segments", cfg};
+            test.execute(ExpectSegment{}.with_no_flags().with_syn(true).with_payload_size(0).with_seqno(isn));
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(10000));
+            test.execute(WriteBytes{string(6000, 'a')});
+            test.execute(ExpectSegment{}.with_payload_size(6000).with_gso_size(1000).with_seqno(isn + 1));
+
+            // the wire segments at 1001 and 3001 are lost
+            test.execute(AckReceived{WrappingInt32{isn + 1001}}.with_win(10000));
+            test.execute(AckReceived{WrappingInt32{isn + 1001}}.with_win(10000).with_sack({block(2001, 3001)}));
+            test.execute(AckReceived{WrappingInt32{isn + 1001}}.with_win(10000).with_sack(
+                {block(4001, 5001), block(2001, 3001)}));
+            test.execute(AckReceived{WrappingInt32{isn + 1001}}.with_win(10000).with_sack(
+                {block(4001, 6001), block(2001, 3001)}));
+            test.execute(ExpectSegment{}.with_payload_size(1000).with_seqno(isn + 1001));
+            test.execute(ExpectNoSegment{});
+            test.execute(AckReceived{WrappingInt32{isn + 3001}}.with_win(10000).with_sack({block(4001, 6001)}));
+            test.execute(ExpectSegment{}.with_payload_size(1000).with_seqno(isn + 3001));
+            test.execute(ExpectNoSegment{});
+            test.execute(AckReceived{WrappingInt32{isn + 6001}}.with_win(10000));
+            test.execute(ExpectBytesInFlight{0});
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return 1;
+    }
+
+    return EXIT_SUCCESS;
+}
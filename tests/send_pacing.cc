@@ -0,0 +1,76 @@
+#include "sender_harness.hh"
+#include "wrapping_integers.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+int main() {
+    try {
+        auto rd = get_random_generator();
+
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+            cfg.pacing = true;
+            cfg.pacing_rate = 1000000;
+
+            TCPSenderTestHarness test{"A fixed pacing rate lets one segment out per millisecond", cfg};
+            test.execute(ExpectSegment{}.with_no_flags().with_syn(true).with_payload_size(0).with_seqno(isn));
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(10000));
+            test.execute(WriteBytes{string(5000, 'a')});
+            test.execute(ExpectNoSegment{});
+            test.execute(Tick{1});
+            test.execute(ExpectSegment{}.with_payload_size(1000).with_seqno(isn + 1));
+            test.execute(ExpectNoSegment{});
+            test.execute(Tick{1});
+            test.execute(ExpectSegment{}.with_payload_size(1000).with_seqno(isn + 1001));
+            test.execute(ExpectNoSegment{});
+
+            // a longer tick lets out what it is worth
+            test.execute(Tick{3});
+            for (unsigned int i = 0; i < 3; i++) {
+                test.execute(ExpectSegment{}.with_payload_size(1000).with_seqno(isn + 2001 + 1000 * i));
+            }
+            test.execute(ExpectNoSegment{});
+            test.execute(AckReceived{WrappingInt32{isn + 5001}}.with_win(10000));
+
+            // while idle, the bucket fills up to two segments only
+            test.execute(Tick{100});
+            test.execute(WriteBytes{string(5000, 'b')});
+            test.execute(ExpectSegment{}.with_payload_size(1000).with_seqno(isn + 5001));
+            test.execute(ExpectSegment{}.with_payload_size(1000).with_seqno(isn + 6001));
+            test.execute(ExpectNoSegment{});
+        }
+
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+            cfg.pacing = true;
+
+            TCPSenderTestHarness test{"Without a fixed rate, the window is paced over half the RTT", cfg};
+            test.execute(ExpectSegment{}.with_no_flags().with_syn(true).with_payload_size(0).with_seqno(isn));
+            test.execute(Tick{10});
+            // an RTT of 10 and a window of 4000 give 800 bytes per millisecond
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(4000));
+            test.execute(WriteBytes{string(3000, 'a')});
+            test.execute(ExpectNoSegment{});
+            for (unsigned int i = 0; i < 3; i++) {
+                test.execute(Tick{1});
+                test.execute(ExpectSegment{}.with_payload_size(1000).with_seqno(isn + 1 + 1000 * i));
+                test.execute(ExpectNoSegment{});
+            }
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return 1;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,127 @@
+#include "sender_harness.hh"
+#include "wrapping_integers.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+int main() {
+    try {
+        auto rd = get_random_generator();
+
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+            cfg.persist_timer = true;
+            const size_t rto = cfg.rt_timeout;
+
+            TCPSenderTestHarness test{"A closed window is probed one byte at a time, with backoff", cfg};
+            test.execute(ExpectSegment{}.with_no_flags().with_syn(true).with_payload_size(0).with_seqno(isn));
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(0));
+            test.execute(WriteBytes{"abc"});
+            test.execute(ExpectNoSegment{});
+
+            test.execute(Tick{rto - 1});
+            test.execute(ExpectNoSegment{});
+            test.execute(Tick{1});
+            test.execute(ExpectSegment{}.with_data("a").with_seqno(isn + 1));
+            test.execute(Tick{2 * rto - 1});
+            test.execute(ExpectNoSegment{});
+            test.execute(Tick{1});
+            test.execute(ExpectSegment{}.with_data("a").with_seqno(isn + 1));
+            test.execute(Tick{4 * rto - 1});
+            test.execute(ExpectNoSegment{});
+            test.execute(Tick{1});
+            test.execute(ExpectSegment{}.with_data("a").with_seqno(isn + 1));
+
+            // the peer takes the probe but keeps the window closed; the backoff goes on
+            test.execute(AckReceived{WrappingInt32{isn + 2}}.with_win(0));
+            test.execute(ExpectNoSegment{});
+            test.execute(Tick{8 * rto - 1});
+            test.execute(ExpectNoSegment{});
+            test.execute(Tick{1});
+            test.execute(ExpectSegment{}.with_data("b").with_seqno(isn + 2));
+
+            // a window update lets the rest out at once
+            test.execute(AckReceived{WrappingInt32{isn + 2}}.with_win(1000));
+            test.execute(ExpectSegment{}.with_data("c").with_seqno(isn + 3));
+            test.execute(ExpectNoSegment{});
+        }
+
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+            cfg.persist_timer = true;
+            cfg.rt_timeout = 100;
+            cfg.max_rto = 300;
+
+            TCPSenderTestHarness test{"Probes that are answered never time the connection out", cfg};
+            test.execute(ExpectSegment{}.with_no_flags().with_syn(true).with_payload_size(0).with_seqno(isn));
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(1000));
+            test.execute(WriteBytes{string(2000, 'a')});
+            test.execute(ExpectSegment{}.with_payload_size(1000).with_seqno(isn + 1));
+
+            // the window closes with a segment in flight, whose first byte becomes the probe
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(0));
+            test.execute(Tick{100});
+            test.execute(ExpectSegment{}.with_payload_size(1).with_seqno(isn + 1));
+            test.execute(Tick{200});
+            test.execute(ExpectSegment{}.with_payload_size(1).with_seqno(isn + 1));
+
+            // the backoff stops at the largest timeout
+            for (unsigned int i = 0; i < 2 * TCPConfig::MAX_RETX_ATTEMPTS; i++) {
+                test.execute(Tick{299}.with_max_retx_exceeded(false));
+                test.execute(ExpectNoSegment{});
+                test.execute(Tick{1});
+                test.execute(ExpectSegment{}.with_payload_size(1).with_seqno(isn + 1));
+                test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(0));
+            }
+
+            // unanswered probes do
+            for (unsigned int i = 0; i < TCPConfig::MAX_RETX_ATTEMPTS; i++) {
+                test.execute(Tick{300}.with_max_retx_exceeded(false));
+                test.execute(ExpectSegment{}.with_payload_size(1).with_seqno(isn + 1));
+            }
+            test.execute(Tick{300}.with_max_retx_exceeded(true));
+        }
+
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+            cfg.persist_timer = true;
+            const size_t rto = cfg.rt_timeout;
+
+            TCPSenderTestHarness test{"A probe the peer takes moves the next probe on a byte", cfg};
+            test.execute(ExpectSegment{}.with_no_flags().with_syn(true).with_payload_size(0).with_seqno(isn));
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(3));
+            test.execute(WriteBytes{"abcdef"});
+            test.execute(ExpectSegment{}.with_data("abc").with_seqno(isn + 1));
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(0));
+            test.execute(Tick{rto});
+            test.execute(ExpectSegment{}.with_data("a").with_seqno(isn + 1));
+
+            // the peer takes the probe's byte but keeps the window closed
+            test.execute(AckReceived{WrappingInt32{isn + 2}}.with_win(0));
+            test.execute(ExpectBytesInFlight{2});
+            test.execute(Tick{2 * rto});
+            test.execute(ExpectSegment{}.with_data("b").with_seqno(isn + 2));
+            test.execute(AckReceived{WrappingInt32{isn + 3}}.with_win(0));
+            test.execute(ExpectBytesInFlight{1});
+            test.execute(Tick{4 * rto});
+            test.execute(ExpectSegment{}.with_data("c").with_seqno(isn + 3));
+            test.execute(ExpectNoSegment{});
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return 1;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,131 @@
+#include "retransmission_timer.hh"
+#include "sender_harness.hh"
+#include "test_err_if.hh"
+#include "wrapping_integers.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+int main() {
+    try {
+        auto rd = get_random_generator();
+
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+            cfg.adaptive_rto = true;
+            cfg.min_rto = 1;
+
+            TCPSenderTestHarness test{"The timeout follows the measured RTT", cfg};
+            test.execute(ExpectSegment{}.with_no_flags().with_syn(true).with_payload_size(0).with_seqno(isn));
+            test.execute(Tick{10});
+            // SRTT = 10 and RTTVAR = 5, so RTO = 10 + 4 * 5
+            test.execute(AckReceived{WrappingInt32{isn + 1}});
+            test.execute(WriteBytes{"abc"});
+            test.execute(ExpectSegment{}.with_data("abc"));
+            test.execute(Tick{29});
+            test.execute(ExpectNoSegment{});
+            test.execute(Tick{1});
+            test.execute(ExpectSegment{}.with_data("abc"));
+
+            // the backoff still doubles the timeout
+            test.execute(Tick{59});
+            test.execute(ExpectNoSegment{});
+            test.execute(Tick{1});
+            test.execute(ExpectSegment{}.with_data("abc"));
+
+            // Karn's rule: the resent segment gives no sample, but the backoff is cleared
+            test.execute(Tick{500});
+            test.execute(ExpectSegment{}.with_data("abc"));
+            test.execute(AckReceived{WrappingInt32{isn + 4}});
+            test.execute(WriteBytes{"def"});
+            test.execute(ExpectSegment{}.with_data("def"));
+            test.execute(Tick{29});
+            test.execute(ExpectNoSegment{});
+            test.execute(Tick{1});
+            test.execute(ExpectSegment{}.with_data("def"));
+        }
+
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+            cfg.adaptive_rto = true;
+            cfg.min_rto = 1;
+            cfg.max_rto = 50;
+
+            TCPSenderTestHarness test{"The backoff stops at the maximum timeout", cfg};
+            test.execute(ExpectSegment{}.with_no_flags().with_syn(true).with_payload_size(0).with_seqno(isn));
+            test.execute(Tick{10});
+            test.execute(AckReceived{WrappingInt32{isn + 1}});
+            test.execute(WriteBytes{"abc"});
+            test.execute(ExpectSegment{}.with_data("abc"));
+            test.execute(Tick{30});
+            test.execute(ExpectSegment{}.with_data("abc"));
+            test.execute(Tick{49});
+            test.execute(ExpectNoSegment{});
+            test.execute(Tick{1});
+            test.execute(ExpectSegment{}.with_data("abc"));
+            test.execute(Tick{50});
+            test.execute(ExpectSegment{}.with_data("abc"));
+        }
+
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+            cfg.adaptive_rto = true;
+            cfg.min_rto = 1;
+
+            TCPSenderTestHarness test{"A timestamp echo gives a sample even for a resent segment", cfg};
+            test.execute(ExpectSegment{}.with_no_flags().with_syn(true).with_payload_size(0).with_seqno(isn));
+            test.execute(Tick{10});
+            test.execute(AckReceived{WrappingInt32{isn + 1}});
+            test.execute(WriteBytes{"abc"});
+            test.execute(ExpectSegment{}.with_data("abc"));
+            test.execute(Tick{30});
+            test.execute(ExpectSegment{}.with_data("abc"));
+            // SRTT = 21.25 and RTTVAR = 26.25, so RTO = 127
+            test.execute(AckReceived{WrappingInt32{isn + 4}}.with_echoed_rtt(100));
+            test.execute(WriteBytes{"def"});
+            test.execute(ExpectSegment{}.with_data("def"));
+            test.execute(Tick{126});
+            test.execute(ExpectNoSegment{});
+            test.execute(Tick{1});
+            test.execute(ExpectSegment{}.with_data("def"));
+        }
+
+        {
+            RetransmissionTimer timer{1000, 200, 60000};
+            timer.rtt_sample(100);
+            timer.reset_timer();
+            test_err_if(timer.rto() != 300, "the first sample should give an RTO of three times the RTT");
+            for (unsigned int i = 0; i < 50; i++) {
+                timer.rtt_sample(100);
+            }
+            timer.reset_timer();
+            test_err_if(timer.rto() != 200, "a steady RTT should bring the RTO down to its minimum");
+            test_err_if(timer.srtt() != 100.0, "the smoothed RTT should settle on a steady RTT");
+
+            timer.rtt_sample(1100);
+            timer.reset_timer();
+            test_err_if(timer.rto() < 1100, "a sudden RTT increase should raise the RTO past it");
+
+            RetransmissionTimer fixed{1000};
+            fixed.rtt_sample(10);
+            fixed.reset_timer();
+            test_err_if(fixed.rto() != 1000, "a timer without RTT estimation should ignore samples");
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return 1;
+    }
+
+    return EXIT_SUCCESS;
+}
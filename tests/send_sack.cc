@@ -0,0 +1,116 @@
+#include "sender_harness.hh"
+#include "wrapping_integers.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+int main() {
+    try {
+        auto rd = get_random_generator();
+
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+            cfg.fast_retransmit = true;
+            const auto block = [&](uint32_t left, uint32_t right) {
+                return TCPHeader::SACKBlock{isn + left, isn + right};
+            };
+
+            TCPSenderTestHarness test{"SACK lets a recovery resend every hole within one round trip", cfg};
+            test.execute(ExpectSegment{}.with_no_flags().with_syn(true).with_payload_size(0).with_seqno(isn));
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(10000));
+            test.execute(WriteBytes{string(8000, 'a')});
+            for (unsigned int i = 0; i < 8; i++) {
+                test.execute(ExpectSegment{}.with_payload_size(1000).with_seqno(isn + 1 + 1000 * i));
+            }
+
+            // the segments at 1001 and 4001 are lost
+            test.execute(AckReceived{WrappingInt32{isn + 1001}}.with_win(10000));
+            test.execute(AckReceived{WrappingInt32{isn + 1001}}.with_win(10000).with_sack({block(2001, 3001)}));
+            test.execute(AckReceived{WrappingInt32{isn + 1001}}.with_win(10000).with_sack({block(2001, 4001)}));
+            test.execute(ExpectNoSegment{});
+            test.execute(AckReceived{WrappingInt32{isn + 1001}}.with_win(10000).with_sack(
+                {block(5001, 6001), block(2001, 4001)}));
+            test.execute(ExpectSegment{}.with_payload_size(1000).with_seqno(isn + 1001));
+            test.execute(ExpectNoSegment{});
+
+            // the next duplicate resends the second hole, without waiting for a partial ACK
+            test.execute(AckReceived{WrappingInt32{isn + 1001}}.with_win(10000).with_sack(
+                {block(5001, 7001), block(2001, 4001)}));
+            test.execute(ExpectSegment{}.with_payload_size(1000).with_seqno(isn + 4001));
+            test.execute(AckReceived{WrappingInt32{isn + 1001}}.with_win(10000).with_sack(
+                {block(5001, 8001), block(2001, 4001)}));
+            test.execute(ExpectNoSegment{});
+
+            // SACKed segments and holes already resent are not sent again
+            test.execute(AckReceived{WrappingInt32{isn + 4001}}.with_win(10000).with_sack({block(5001, 8001)}));
+            test.execute(ExpectNoSegment{});
+            test.execute(AckReceived{WrappingInt32{isn + 8001}}.with_win(10000));
+            test.execute(ExpectNoSegment{});
+            test.execute(ExpectBytesInFlight{0});
+        }
+
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+            const auto block = [&](uint32_t left, uint32_t right) {
+                return TCPHeader::SACKBlock{isn + left, isn + right};
+            };
+
+            TCPSenderTestHarness test{"After a timeout, the next ACK resends the next hole", cfg};
+            test.execute(ExpectSegment{}.with_no_flags().with_syn(true).with_payload_size(0).with_seqno(isn));
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(10000));
+            test.execute(WriteBytes{string(5000, 'a')});
+            for (unsigned int i = 0; i < 5; i++) {
+                test.execute(ExpectSegment{}.with_payload_size(1000).with_seqno(isn + 1 + 1000 * i));
+            }
+
+            // the segments at 1 and 2001 are lost
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(10000).with_sack({block(1001, 2001)}));
+            test.execute(
+                AckReceived{WrappingInt32{isn + 1}}.with_win(10000).with_sack({block(3001, 5001), block(1001, 2001)}));
+            test.execute(ExpectNoSegment{});
+            test.execute(Tick{cfg.rt_timeout});
+            test.execute(ExpectSegment{}.with_payload_size(1000).with_seqno(isn + 1));
+            test.execute(AckReceived{WrappingInt32{isn + 2001}}.with_win(10000).with_sack({block(3001, 5001)}));
+            test.execute(ExpectSegment{}.with_payload_size(1000).with_seqno(isn + 2001));
+            test.execute(ExpectNoSegment{});
+            test.execute(AckReceived{WrappingInt32{isn + 5001}}.with_win(10000));
+            test.execute(ExpectNoSegment{});
+        }
+
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+            const auto block = [&](uint32_t left, uint32_t right) {
+                return TCPHeader::SACKBlock{isn + left, isn + right};
+            };
+
+            TCPSenderTestHarness test{"SACK blocks outside the outstanding data are ignored", cfg};
+            test.execute(ExpectSegment{}.with_no_flags().with_syn(true).with_payload_size(0).with_seqno(isn));
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(10000));
+            test.execute(WriteBytes{string(2000, 'a')});
+            test.execute(ExpectSegment{}.with_payload_size(1000).with_seqno(isn + 1));
+            test.execute(ExpectSegment{}.with_payload_size(1000).with_seqno(isn + 1001));
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(10000).with_sack({block(1001, 5001)}));
+            test.execute(Tick{cfg.rt_timeout});
+            test.execute(ExpectSegment{}.with_payload_size(1000).with_seqno(isn + 1));
+            test.execute(AckReceived{WrappingInt32{isn + 1001}}.with_win(10000));
+            test.execute(ExpectNoSegment{});
+            test.execute(ExpectBytesInFlight{1000});
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return 1;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -15,6 +15,7 @@
 #include <optional>
 #include <sstream>
 #include <string>
+#include <vector>
 
 const unsigned int DEFAULT_TEST_WINDOW = 137;
 
@@ -191,11 +192,19 @@ struct Tick : public SenderAction {
 struct AckReceived : public SenderAction {
     WrappingInt32 _ackno;
     std::optional<uint16_t> _window_advertisement{};
+    TCPHeader::SACKBlocks _sack{};
+    std::optional<uint64_t> _echoed_rtt{};
 
     AckReceived(WrappingInt32 ackno) : _ackno(ackno) {}
     std::string description() const {
         std::ostringstream ss;
         ss << "ack " << _ackno.raw_value() << " winsize " << _window_advertisement.value_or(DEFAULT_TEST_WINDOW);
+        for (const auto &block : _sack) {
+            ss << " sack " << block.left.raw_value() << "-" << block.right.raw_value();
+        }
+        if (_echoed_rtt.has_value()) {
+            ss << " echoed rtt " << _echoed_rtt.value();
+        }
         return ss.str();
     }
 
@@ -204,7 +213,21 @@ struct AckReceived : public SenderAction {
         return *this;
     }
 
+    AckReceived &with_sack(const TCPHeader::SACKBlocks &sack) {
+        _sack = sack;
+        return *this;
+    }
+
+    AckReceived &with_echoed_rtt(uint64_t rtt) {
+        _echoed_rtt.emplace(rtt);
+        return *this;
+    }
+
     void execute(TCPSender &sender, std::queue<TCPSegment> &) const {
+        sender.sack_received(_sack);
+        if (_echoed_rtt.has_value()) {
+            sender.echoed_rtt_received(_echoed_rtt.value());
+        }
         sender.ack_received(_ackno, _window_advertisement.value_or(DEFAULT_TEST_WINDOW));
         sender.fill_window();
     }
@@ -229,6 +252,7 @@ struct ExpectSegment : public SenderExpectation {
     std::optional<WrappingInt32> ackno{};
     std::optional<uint16_t> win{};
     std::optional<size_t> payload_size{};
+    std::optional<size_t> gso_size{};
     std::optional<std::string> data{};
 
     ExpectSegment &with_ack(bool ack_) {
@@ -288,6 +312,11 @@ struct ExpectSegment : public SenderExpectation {
         return *this;
     }
 
+    ExpectSegment &with_gso_size(size_t gso_size_) {
+        gso_size = gso_size_;
+        return *this;
+    }
+
     std::string segment_description() const {
         std::ostringstream o;
         o << "(";
@@ -315,6 +344,9 @@ struct ExpectSegment : public SenderExpectation {
         if (payload_size.has_value()) {
             o << "payload_size=" << payload_size.value() << ",";
         }
+        if (gso_size.has_value()) {
+            o << "gso_size=" << gso_size.value() << ",";
+        }
         if (data.has_value()) {
             o << "\"";
             for (unsigned int i = 0; i < std::min(size_t(16), data.value().size()); i++) {
@@ -367,8 +399,13 @@ struct ExpectSegment : public SenderExpectation {
             throw SegmentExpectationViolation::violated_field(
                 "payload_size", payload_size.value(), seg.payload().size());
         }
-        if (seg.payload().size() > TCPConfig::MAX_PAYLOAD_SIZE) {
-            throw SegmentExpectationViolation("packet has length (" + std::to_string(seg.payload().size()) +
+        if (gso_size.has_value() and seg.gso_size() != gso_size.value()) {
+            throw SegmentExpectationViolation::violated_field("gso_size", gso_size.value(), seg.gso_size());
+        }
+        // a segment built for GSO goes on the wire in pieces of its gso_size
+        const size_t wire_payload = seg.gso_size() != 0 ? seg.gso_size() : seg.payload().size();
+        if (wire_payload > TCPConfig::MAX_PAYLOAD_SIZE) {
+            throw SegmentExpectationViolation("packet has length (" + std::to_string(wire_payload) +
                                               ") greater than the maximum");
         }
         if (data.has_value() and seg.payload().str() != data.value()) {
@@ -394,7 +431,7 @@ class TCPSenderTestHarness {
   public:
     TCPSenderTestHarness(const std::string &name_, TCPConfig config)
         : outbound_segments()
-        , sender(config.send_capacity, config.rt_timeout, config.fixed_isn)
+        , sender(config)
         , steps_executed()
         , name(name_) {
         sender.fill_window();
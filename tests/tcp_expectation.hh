@@ -11,6 +11,7 @@
 #include <exception>
 #include <optional>
 #include <sstream>
+#include <vector>
 
 struct TCPExpectation : public TCPTestStep {
     virtual ~TCPExpectation() {}
@@ -123,6 +124,11 @@ struct ExpectSegment : public TCPExpectation {
     std::optional<uint16_t> win{};
     std::optional<size_t> payload_size{};
     std::optional<std::string> data{};
+    std::optional<uint16_t> mss{};
+    std::optional<uint8_t> window_scale{};
+    std::optional<uint32_t> timestamp_echo{};
+    std::optional<bool> sack_permitted{};
+    std::optional<TCPHeader::SACKBlocks> sack{};
 
     ExpectSegment &with_ack(bool ack_) {
         ack = ack_;
@@ -181,6 +187,31 @@ struct ExpectSegment : public TCPExpectation {
         return *this;
     }
 
+    ExpectSegment &with_mss(uint16_t mss_) {
+        mss = mss_;
+        return *this;
+    }
+
+    ExpectSegment &with_window_scale(uint8_t window_scale_) {
+        window_scale = window_scale_;
+        return *this;
+    }
+
+    ExpectSegment &with_timestamp_echo(uint32_t timestamp_echo_) {
+        timestamp_echo = timestamp_echo_;
+        return *this;
+    }
+
+    ExpectSegment &with_sack_permitted(bool sack_permitted_) {
+        sack_permitted = sack_permitted_;
+        return *this;
+    }
+
+    ExpectSegment &with_sack(TCPHeader::SACKBlocks sack_) {
+        sack = std::move(sack_);
+        return *this;
+    }
+
     std::string segment_description() const {
         std::ostringstream o;
         o << "(";
@@ -213,6 +244,25 @@ struct ExpectSegment : public TCPExpectation {
             append_data(o, data.value());
             o << ",";
         }
+        if (mss.has_value()) {
+            o << "mss=" << mss.value() << ",";
+        }
+        if (window_scale.has_value()) {
+            o << "wscale=" << +window_scale.value() << ",";
+        }
+        if (timestamp_echo.has_value()) {
+            o << "tsecr=" << timestamp_echo.value() << ",";
+        }
+        if (sack_permitted.has_value()) {
+            o << (sack_permitted.value() ? "sackok=1," : "sackok=0,");
+        }
+        if (sack.has_value()) {
+            o << "sack=";
+            for (const auto &block : sack.value()) {
+                o << block.left << "-" << block.right << ";";
+            }
+            o << ",";
+        }
         o << ")";
         return o.str();
     }
@@ -260,6 +310,23 @@ struct ExpectSegment : public TCPExpectation {
         if (data.has_value() and seg.payload().str() != *data) {
             throw SegmentExpectationViolation("payloads differ");
         }
+        if (mss.has_value() and seg.header().mss != mss) {
+            throw SegmentExpectationViolation("MSS differs: got " + seg.header().summary());
+        }
+        if (window_scale.has_value() and seg.header().window_scale != window_scale) {
+            throw SegmentExpectationViolation("window scale differs: got " + seg.header().summary());
+        }
+        if (timestamp_echo.has_value() and
+            (not seg.header().timestamp.has_value() or seg.header().timestamp->echo_reply != timestamp_echo)) {
+            throw SegmentExpectationViolation("timestamp echo differs: got " + seg.header().summary());
+        }
+        if (sack_permitted.has_value() and seg.header().sack_permitted != sack_permitted.value()) {
+            throw SegmentExpectationViolation::violated_field(
+                "sack_permitted", sack_permitted.value(), seg.header().sack_permitted);
+        }
+        if (sack.has_value() and seg.header().sack != sack.value()) {
+            throw SegmentExpectationViolation("SACK blocks differ: got " + seg.header().summary());
+        }
         return seg;
     }
 
@@ -392,6 +459,10 @@ struct SendSegment : public TCPAction {
     uint16_t win{0};
     size_t payload_size{0};
     std::string data{};
+    std::optional<uint16_t> mss{};
+    std::optional<uint8_t> window_scale{};
+    std::optional<TCPHeader::Timestamp> timestamp{};
+    bool sack_permitted{false};
 
     SendSegment() {}
 
@@ -455,6 +526,26 @@ struct SendSegment : public TCPAction {
         return *this;
     }
 
+    SendSegment &with_mss(uint16_t mss_) {
+        mss = mss_;
+        return *this;
+    }
+
+    SendSegment &with_window_scale(uint8_t window_scale_) {
+        window_scale = window_scale_;
+        return *this;
+    }
+
+    SendSegment &with_timestamp(uint32_t value, uint32_t echo_reply) {
+        timestamp = TCPHeader::Timestamp{value, echo_reply};
+        return *this;
+    }
+
+    SendSegment &with_sack_permitted(bool sack_permitted_) {
+        sack_permitted = sack_permitted_;
+        return *this;
+    }
+
     TCPSegment get_segment() const {
         TCPSegment data_seg;
         data_seg.payload() = std::string(data);
@@ -466,6 +557,11 @@ struct SendSegment : public TCPAction {
         data_hdr.ackno = ackno;
         data_hdr.seqno = seqno;
         data_hdr.win = win;
+        data_hdr.mss = mss;
+        data_hdr.window_scale = window_scale;
+        data_hdr.timestamp = timestamp;
+        data_hdr.sack_permitted = sack_permitted;
+        data_hdr.doff = data_hdr.required_doff();
         return data_seg;
     }
 
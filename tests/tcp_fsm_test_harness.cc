@@ -67,7 +67,9 @@ void TestFdAdapter::config_segment(TCPSegment &seg) {
 //! \param[in] seg is the TCPSegment to write
 void TestFdAdapter::write(TCPSegment &seg) {
     config_segment(seg);
-    TestFD::write(seg.serialize());
+    for (const TCPSegment &piece : seg.split()) {
+        TestFD::write(piece.serialize());
+    }
 }
 
 //! \param[in] seqno is the sequence number of the segment
@@ -0,0 +1,140 @@
+#include "tcp_receiver.hh"
+#include "tcp_segment.hh"
+#include "tcp_segment_coalescer.hh"
+#include "test_err_if.hh"
+#include "test_should_be.hh"
+
+#include <cstdint>
+#include <exception>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+static TCPSegment data_segment(const uint32_t seqno, const string &payload) {
+    TCPSegment seg{};
+    seg.header().ack = true;
+    seg.header().ackno = WrappingInt32{500};
+    seg.header().seqno = WrappingInt32{seqno};
+    seg.header().win = 1000;
+    seg.header().timestamp = TCPHeader::Timestamp{7, 8};
+    seg.payload() = string(payload);
+    return seg;
+}
+
+int main() {
+    try {
+        string payload(3500, 'x');
+        for (size_t i = 0; i < payload.size(); i++) {
+            payload[i] = static_cast<char>(i * 13);
+        }
+
+        // an in-order run merges into one segment, which keeps the original pieces
+        {
+            TCPSegment sent = data_segment(1000, payload);
+            sent.header().fin = true;
+            sent.gso_size() = 1000;
+
+            TCPSegmentCoalescer gro{};
+            for (TCPSegment &piece : sent.split()) {
+                gro.push(move(piece));
+            }
+            const vector<TCPSegment> merged = gro.take();
+            test_should_be(merged.size(), size_t(1));
+            test_err_if(not(merged[0].header() == sent.header()), "the merged header should match the first piece's");
+            string merged_payload{merged[0].payload()};
+            for (const Buffer &piece : merged[0].merged_payload()) {
+                // the pieces still share the storage they were read into
+                test_err_if(piece.storage() != sent.payload().storage(), "merging should not copy the payload");
+                merged_payload.append(piece);
+            }
+            test_err_if(merged_payload != payload, "the merged payload should be the pieces in order");
+            test_should_be(merged[0].payload_size(), payload.size());
+            test_should_be(merged[0].gso_size(), size_t(1000));
+            test_err_if(not gro.empty(), "take() should empty the coalescer");
+        }
+
+        // segments that can't be merged are handed over as they were read
+        {
+            TCPSegmentCoalescer gro{};
+            gro.push(data_segment(1000, payload.substr(0, 1000)));
+            gro.push(data_segment(2000, payload.substr(1000, 500)));
+            // after a short piece
+            gro.push(data_segment(2500, payload.substr(1500, 1000)));
+            // a gap
+            gro.push(data_segment(4000, payload.substr(2500, 1000)));
+            // a different ackno
+            TCPSegment new_ack = data_segment(5000, payload.substr(0, 1000));
+            new_ack.header().ackno = WrappingInt32{600};
+            gro.push(move(new_ack));
+            // a different timestamp
+            TCPSegment later = data_segment(6000, payload.substr(0, 1000));
+            later.header().timestamp = TCPHeader::Timestamp{9, 8};
+            later.header().ackno = WrappingInt32{600};
+            gro.push(move(later));
+            // after a PSH
+            TCPSegment pushed = data_segment(7000, payload.substr(0, 1000));
+            pushed.header().timestamp = TCPHeader::Timestamp{9, 8};
+            pushed.header().ackno = WrappingInt32{600};
+            pushed.header().psh = true;
+            gro.push(move(pushed));
+            TCPSegment after_push = data_segment(8000, payload.substr(0, 1000));
+            after_push.header().timestamp = TCPHeader::Timestamp{9, 8};
+            after_push.header().ackno = WrappingInt32{600};
+            gro.push(move(after_push));
+
+            const vector<TCPSegment> segments = gro.take();
+            const vector<uint32_t> seqnos{1000, 2500, 4000, 5000, 6000, 8000};
+            test_should_be(segments.size(), seqnos.size());
+            for (size_t i = 0; i < seqnos.size(); i++) {
+                test_should_be(segments[i].header().seqno.raw_value(), seqnos[i]);
+            }
+            test_should_be(segments[0].payload_size(), size_t(1500));
+            test_should_be(segments[0].gso_size(), size_t(1000));
+            test_should_be(segments[2].gso_size(), size_t(0));
+            test_err_if(not segments[4].header().psh, "the merged segment takes the PSH of its last piece");
+        }
+
+        // segments of another flow aren't merged, even when their seqnos line up
+        {
+            TCPSegmentCoalescer gro{};
+            gro.push(data_segment(1000, payload.substr(0, 1000)));
+            TCPSegment other_sport = data_segment(2000, payload.substr(1000, 1000));
+            other_sport.header().sport = 1234;
+            gro.push(move(other_sport));
+            TCPSegment other_dport = data_segment(3000, payload.substr(2000, 1000));
+            other_dport.header().sport = 1234;
+            other_dport.header().dport = 5678;
+            gro.push(move(other_dport));
+            test_should_be(gro.take().size(), size_t(3));
+        }
+
+        // the receiver takes a merged segment's pieces in order, and its FIN after the last one
+        {
+            TCPReceiver receiver{4000};
+            TCPSegment syn{};
+            syn.header().syn = true;
+            syn.header().seqno = WrappingInt32{999};
+            receiver.segment_received(syn);
+
+            TCPSegment sent = data_segment(1000, payload);
+            sent.header().fin = true;
+            sent.gso_size() = 1000;
+            TCPSegmentCoalescer gro{};
+            for (TCPSegment &piece : sent.split()) {
+                gro.push(move(piece));
+            }
+            receiver.segment_received(gro.take().at(0));
+            test_err_if(receiver.stream_out().read(payload.size()) != payload,
+                        "the stream should hold the pieces in order");
+            test_err_if(not receiver.stream_out().input_ended(), "the FIN should end the stream");
+            test_should_be(receiver.ackno().value().raw_value(), uint32_t(1000 + payload.size() + 1));
+        }
+    } catch (const exception &e) {
+        cerr << "Exception: " << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
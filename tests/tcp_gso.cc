@@ -0,0 +1,78 @@
+#include "ipv4_datagram.hh"
+#include "tcp_over_ip.hh"
+#include "tcp_segment.hh"
+#include "test_err_if.hh"
+#include "test_should_be.hh"
+
+#include <cstdint>
+#include <exception>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+int main() {
+    try {
+        string payload(3500, 'x');
+        for (size_t i = 0; i < payload.size(); i++) {
+            payload[i] = static_cast<char>(i * 7);
+        }
+
+        TCPSegment seg{};
+        seg.header().ack = true;
+        seg.header().ackno = WrappingInt32{77};
+        seg.header().seqno = WrappingInt32{1000};
+        seg.header().fin = true;
+        seg.header().win = 1234;
+        seg.header().timestamp = TCPHeader::Timestamp{5, 6};
+        seg.header().doff = seg.header().required_doff();
+        seg.payload() = string(payload);
+        seg.gso_size() = 1000;
+
+        TCPOverIPv4Adapter adapter{};
+        adapter.config_mut().source = {"10.0.0.1", 1111};
+        adapter.config_mut().destination = {"10.0.0.2", 2222};
+        const vector<InternetDatagram> dgrams = adapter.wrap_tcp_in_ips(seg);
+        test_should_be(dgrams.size(), size_t(4));
+
+        string reassembled{};
+        for (size_t i = 0; i < dgrams.size(); i++) {
+            InternetDatagram dgram{};
+            test_err_if(dgram.parse(Buffer{dgrams[i].serialize().concatenate()}) != ParseResult::NoError,
+                        "each datagram should parse");
+            TCPSegment piece{};
+            test_err_if(piece.parse(dgram.payload().concatenate(), dgram.header().pseudo_cksum()) !=
+                            ParseResult::NoError,
+                        "each piece should have a good checksum");
+            test_should_be(piece.header().seqno.raw_value(), uint32_t(1000 + 1000 * i));
+            test_should_be(piece.payload().size(), size_t(i < 3 ? 1000 : 500));
+            test_should_be(piece.header().sport, uint16_t(1111));
+            test_should_be(piece.header().ackno.raw_value(), uint32_t(77));
+            test_should_be(piece.header().win, uint16_t(1234));
+            test_err_if(not piece.header().timestamp.has_value() or piece.header().timestamp->value != 5,
+                        "the options should be on every piece");
+            test_err_if(piece.header().fin != (i == 3), "only the last piece carries the FIN");
+            reassembled.append(piece.payload().str());
+        }
+        test_err_if(reassembled != payload, "the pieces should carry the payload in order");
+
+        // without a gso_size, the segment goes out whole
+        seg.gso_size() = 0;
+        test_should_be(adapter.wrap_tcp_in_ips(seg).size(), size_t(1));
+        test_should_be(seg.split().size(), size_t(1));
+
+        // a SYN with data takes the first seqno
+        seg.header().syn = true;
+        seg.gso_size() = 2000;
+        const vector<TCPSegment> pieces = seg.split();
+        test_should_be(pieces.size(), size_t(2));
+        test_err_if(not pieces[0].header().syn or pieces[1].header().syn, "only the first piece carries the SYN");
+        test_should_be(pieces[1].header().seqno.raw_value(), uint32_t(1000 + 1 + 2000));
+    } catch (const exception &e) {
+        cerr << "Exception: " << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
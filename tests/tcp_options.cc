@@ -0,0 +1,183 @@
+#include "parser.hh"
+#include "tcp_header.hh"
+#include "test_err_if.hh"
+#include "test_should_be.hh"
+
+#include <cstdint>
+#include <exception>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+
+using namespace std;
+
+//! Parse a serialized header, which must succeed
+static TCPHeader parse_header(string &&bytes) {
+    TCPHeader header{};
+    NetParser p{Buffer{move(bytes)}};
+    test_err_if(header.parse(p) != ParseResult::NoError, "header should parse");
+    return header;
+}
+
+//! Serialize a header with its options packed, and check that it parses back the same
+static void check_round_trip(TCPHeader header) {
+    header.doff = header.required_doff();
+    const TCPHeader parsed = parse_header(header.serialize());
+    test_err_if(not(parsed == header), "header should survive a round trip: " + header.summary());
+}
+
+//! \brief Round-trip the header of every TCP segment in a capture of Ethernet frames
+//! \returns the number of segments that carried options
+//! \details Reads the classic pcap format directly (little-endian, as the corpus is), so it needs no libpcap.
+static size_t round_trip_capture(const string &filename) {
+    ifstream file{filename, ios::binary};
+    test_err_if(not file, "could not open " + filename);
+    const string capture{istreambuf_iterator<char>{file}, istreambuf_iterator<char>{}};
+    const auto u8 = [&](size_t offset) { return static_cast<uint8_t>(capture.at(offset)); };
+    const auto le32 = [&](size_t offset) {
+        return uint32_t{u8(offset)} | uint32_t{u8(offset + 1)} << 8 | uint32_t{u8(offset + 2)} << 16 |
+               uint32_t{u8(offset + 3)} << 24;
+    };
+    test_err_if(le32(0) != 0xa1b2c3d4 or le32(20) != 1, "expected a little-endian capture of Ethernet frames");
+
+    size_t with_options = 0;
+    for (size_t record = 24; record + 16 <= capture.size();) {
+        const size_t frame = record + 16;
+        const size_t caplen = le32(record + 8);
+        record = frame + caplen;
+        // IPv4 (without fragments) carrying TCP
+        if (caplen < 34 or u8(frame + 12) != 0x08 or u8(frame + 13) != 0x00 or u8(frame + 23) != 6) {
+            continue;
+        }
+        const size_t tcp = frame + 14 + 4 * (u8(frame + 14) & 0x0f);
+        if (tcp + TCPHeader::LENGTH > frame + caplen or tcp + 4 * (u8(tcp + 12) >> 4) > frame + caplen) {
+            continue;
+        }
+        TCPHeader header = parse_header(capture.substr(tcp, 4 * (u8(tcp + 12) >> 4)));
+        with_options += header.doff > TCPHeader::LENGTH / 4;
+        check_round_trip(header);
+    }
+    return with_options;
+}
+
+int main(int argc, char **argv) {
+    try {
+        {
+            TCPHeader header{};
+            header.syn = true;
+            header.seqno = WrappingInt32{1234};
+            header.mss = 1460;
+            header.window_scale = 7;
+            header.sack_permitted = true;
+            header.sack = {{WrappingInt32{100}, WrappingInt32{200}}, {WrappingInt32{300}, WrappingInt32{0xffff0000}}};
+            header.doff = header.required_doff();
+            test_should_be(header.doff, uint8_t(13));
+
+            const TCPHeader parsed = parse_header(header.serialize());
+            test_err_if(not(parsed == header), "MSS, window scale and SACK options should survive a round trip");
+            test_should_be(parsed.mss.value_or(0), uint16_t(1460));
+            test_should_be(parsed.window_scale.value_or(0), uint8_t(7));
+            test_should_be(parsed.sack.size(), size_t(2));
+            test_should_be(parsed.sack.at(1).right.raw_value(), uint32_t(0xffff0000));
+
+            header.doff = 5;
+            bool threw = false;
+            try {
+                header.serialize();
+            } catch (const runtime_error &) {
+                threw = true;
+            }
+            test_err_if(not threw, "a doff too short for the options should throw");
+        }
+
+        {
+            // timestamps with the most SACK blocks that still fit in 40 bytes of options
+            TCPHeader header{};
+            header.ack = true;
+            header.timestamp = TCPHeader::Timestamp{0xdeadbeef, 42};
+            header.sack = {{WrappingInt32{100}, WrappingInt32{200}},
+                           {WrappingInt32{300}, WrappingInt32{400}},
+                           {WrappingInt32{500}, WrappingInt32{600}}};
+            header.doff = header.required_doff();
+            test_should_be(header.doff, uint8_t(15));
+
+            const TCPHeader parsed = parse_header(header.serialize());
+            test_err_if(not(parsed == header), "timestamps and SACK options should survive a round trip");
+            test_should_be(parsed.timestamp.value_or(TCPHeader::Timestamp{0, 0}).value, uint32_t(0xdeadbeef));
+            test_should_be(parsed.timestamp.value_or(TCPHeader::Timestamp{0, 0}).echo_reply, uint32_t(42));
+        }
+
+        {
+            // an unknown option is kept, and parsing stops at a malformed one
+            TCPHeader header{};
+            header.doff = 8;
+            string bytes = header.serialize();
+            bytes.replace(TCPHeader::LENGTH, 12, string("\x02\x04\x05\xb4\x1e\x02\x04\x02\x05\x01\x00\x00", 12));
+            const TCPHeader parsed = parse_header(move(bytes));
+            test_should_be(parsed.mss.value_or(0), uint16_t(1460));
+            test_err_if(not parsed.sack_permitted, "SACK-permitted after an unknown option");
+            test_should_be(parsed.sack.size(), size_t(0));
+            test_should_be(parsed.doff, uint8_t(8));
+            test_err_if(parsed.other_options.find(30) != string_view{}, "the unknown option should be kept");
+            check_round_trip(parsed);
+        }
+
+        {
+            // options this stack doesn't know survive a round trip next to the ones it does
+            TCPHeader header{};
+            header.mss = 1200;
+            test_err_if(not header.other_options.add(34, "\x01\x02\x03"), "a TFO cookie should fit");
+            test_err_if(not header.other_options.add(253, "exp"), "an experimental option should fit");
+            header.doff = header.required_doff();
+            test_should_be(header.doff, uint8_t(9));
+            const TCPHeader parsed = parse_header(header.serialize());
+            test_err_if(not(parsed == header), "unknown options should survive a round trip");
+            test_err_if(parsed.other_options.find(253) != string_view{"exp"}, "the experimental option's value");
+            test_err_if(parsed.other_options.find(28).has_value(), "no such option");
+            test_err_if(header.other_options.add(254, string(32, 'x')), "40 bytes of options at most");
+        }
+
+        {
+            // the option layouts of real SYNs and ACKs parse the same after being repacked
+            const string linux_syn("\x02\x04\x05\xb4\x04\x02\x08\x0a\x00\x01\x02\x03"
+                                   "\x00\x00\x00\x00\x01\x03\x03\x07",
+                                   20);
+            const string windows_syn("\x02\x04\x05\xb4\x01\x03\x03\x08\x01\x01\x04\x02", 12);
+            const string sack_ack("\x01\x01\x08\x0a\x00\x00\x00\x05\x00\x00\x00\x06"
+                                  "\x01\x01\x05\x12\x00\x00\x03\xe8\x00\x00\x07\xd0\x00\x00\x0b\xb8\x00\x00\x0f\xa0",
+                                  32);
+            for (const string &options : {linux_syn, windows_syn, sack_ack}) {
+                TCPHeader header{};
+                header.doff = (TCPHeader::LENGTH + options.size()) / 4;
+                string bytes = header.serialize();
+                bytes.replace(TCPHeader::LENGTH, options.size(), options);
+                const TCPHeader parsed = parse_header(move(bytes));
+                test_err_if(not parsed.other_options.empty(), "only known options: " + parsed.summary());
+                check_round_trip(parsed);
+            }
+
+            TCPHeader linux_header{};
+            linux_header.doff = 10;
+            string bytes = linux_header.serialize();
+            bytes.replace(TCPHeader::LENGTH, linux_syn.size(), linux_syn);
+            linux_header = parse_header(move(bytes));
+            test_should_be(linux_header.mss.value_or(0), uint16_t(1460));
+            test_should_be(linux_header.window_scale.value_or(0), uint8_t(7));
+            test_should_be(linux_header.timestamp.value_or(TCPHeader::Timestamp{0, 0}).value, uint32_t(0x10203));
+            test_err_if(not linux_header.sack_permitted, "the Linux SYN permits SACK");
+        }
+
+        // every TCP header in the corpus survives a round trip
+        if (argc < 2) {
+            cerr << "USAGE: " << argv[0] << " <capture file>" << endl;
+            return EXIT_FAILURE;
+        }
+        test_err_if(round_trip_capture(argv[1]) == 0, "the corpus should have segments with options");
+    } catch (const exception &e) {
+        cerr << "Exception: " << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -196,8 +196,8 @@ int main(int argc, char **argv) {
                 auto &tcp_hdr_orig = tcp_seg.header();
                 TCPHeader &tcp_hdr_copy = tcp_seg_copy.header();
                 tcp_hdr_copy = tcp_hdr_orig;
-                // fix up segment to remove IPv4 and TCP header extensions
-                tcp_hdr_copy.doff = 5;
+                // fix up segment to remove IPv4 extensions and the TCP header's padding
+                tcp_hdr_copy.doff = tcp_hdr_copy.required_doff();
             }  // tcp_hdr_{orig,copy} go out of scope
 
             if (!compare_tcp_headers_nolen(tcp_seg.header(), tcp_seg_copy.header())) {